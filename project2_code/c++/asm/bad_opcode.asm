@@ -0,0 +1,3 @@
+	ADDI R1 R1 1
+	MOVE R2 R1
+	EOP
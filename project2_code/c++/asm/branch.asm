@@ -0,0 +1,6 @@
+LOOP:	AND R4 R1 R3
+	BEQZ R4 SKIP
+	ADDI R5 R5 1
+SKIP:	SUBI R1 R1 1
+	BNEZ R1 LOOP
+	EOP
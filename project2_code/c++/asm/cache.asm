@@ -0,0 +1,5 @@
+	LW R1 0(R2)
+	LW R3 0x400(R2)
+	LW R4 4(R2)
+	SW R1 0x404(R2)
+	EOP
@@ -0,0 +1,5 @@
+	MULTS F2 F1 F1
+	ADDI R2 R1 1
+	ADDI R3 R1 2
+	ADDI R4 R1 3
+	EOP
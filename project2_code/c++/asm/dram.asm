@@ -0,0 +1,5 @@
+	LW R1 0(R2)
+	LW R3 0x40(R2)
+	LW R4 0x800(R2)
+	LW R5 0x1000(R2)
+	EOP
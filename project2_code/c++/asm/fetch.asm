@@ -0,0 +1,8 @@
+LOOP:	ADDI R2 R2 1
+	ADDI R3 R3 2
+	ADDI R4 R4 3
+	ADDI R5 R5 4
+	ADDI R6 R6 5
+	SUBI R1 R1 1
+	BNEZ R1 LOOP
+	EOP
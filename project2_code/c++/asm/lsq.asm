@@ -0,0 +1,8 @@
+	DIV R5 R6 R7
+	SW R2 0(R5)
+	LW R3 8(R1)
+	SW R2 0(R1)
+	LW R4 0(R1)
+	SW R2 6(R1)
+	LW R8 4(R1)
+	EOP
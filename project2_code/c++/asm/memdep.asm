@@ -0,0 +1,8 @@
+LOOP:	LW R4 0(R1)
+	SW R2 0(R4)
+	LW R5 0(R3)
+	ADD R9 R9 R5
+	ADDI R1 R1 4
+	SUBI R2 R2 1
+	BNEZ R2 LOOP
+	EOP
@@ -0,0 +1,9 @@
+	MULTS F1 F0 F0
+	MULTS F2 F0 F0
+	MULTS F3 F0 F0
+	MULTS F4 F0 F0
+	MULTS F5 F0 F0
+	MULTS F6 F0 F0
+	MULTS F7 F0 F0
+	MULTS F8 F0 F0
+	EOP
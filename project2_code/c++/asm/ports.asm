@@ -0,0 +1,7 @@
+	LW R2 0(R1)
+	LW R3 4(R1)
+	LW R4 8(R1)
+	LW R5 12(R1)
+	SW R2 16(R1)
+	SW R3 20(R1)
+	EOP
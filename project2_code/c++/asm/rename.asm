@@ -0,0 +1,9 @@
+	ADDI R1 R1 1
+	ADDI R2 R1 2
+	ADDS F1 F2 F3
+	ADDI R1 R2 3
+	ADD R3 R1 R2
+	ADDS F4 F1 F1
+	SUB R4 R3 R1
+	ADD R5 R1 R1
+	EOP
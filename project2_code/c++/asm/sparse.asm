@@ -0,0 +1,4 @@
+	LW R1 0(R2)
+	ADDI R1 R1 1
+	SW R1 0(R3)
+	EOP
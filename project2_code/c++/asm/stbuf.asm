@@ -0,0 +1,8 @@
+	SW R2 0(R1)
+	SW R2 4(R1)
+	SW R2 8(R1)
+	SW R2 18(R1)
+	DIV R5 R6 R7
+	LW R3 4(R5)
+	LW R4 20(R5)
+	EOP
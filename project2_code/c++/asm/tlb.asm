@@ -0,0 +1,6 @@
+	LW R1 0(R0)
+	LW R2 4(R0)
+	LW R3 0x1000(R0)
+	LW R4 0x2000(R0)
+	SW R1 0x1004(R0)
+	EOP
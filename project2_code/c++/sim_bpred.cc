@@ -0,0 +1,243 @@
+#include "sim_bpred.h"
+#include "sim_ooo.h"
+#include <math.h>
+
+using namespace std;
+
+/* 2-bit saturating counters (0-1: not taken, 2-3: taken) */
+static void saturate(unsigned char &counter, bool taken){
+	if (taken && counter < 3) counter++;
+	if (!taken && counter > 0) counter--;
+}
+
+sim_bpred::sim_bpred(){
+	speculative_history = 0;
+	committed_history = 0;
+}
+
+bool sim_bpred::predict(unsigned pc, unsigned long long *history){
+	*history = speculative_history;
+	bool taken = lookup(pc, speculative_history);
+	speculative_history = (speculative_history << 1) | (taken ? 1 : 0);
+	return taken;
+}
+
+void sim_bpred::update(unsigned pc, bool taken, unsigned long long history){
+	train(pc, taken, history);
+	committed_history = (committed_history << 1) | (taken ? 1 : 0);
+}
+
+unsigned long long sim_bpred::get_history(){return speculative_history;}
+
+void sim_bpred::recover(){
+	speculative_history = committed_history;
+}
+
+void sim_bpred::recover(unsigned long long history){
+	speculative_history = history;
+}
+
+/* predicts not taken: every taken branch is a misprediction */
+class static_predictor : public sim_bpred{
+protected:
+	bool lookup(unsigned pc, unsigned long long history){return false;}
+	void train(unsigned pc, bool taken, unsigned long long history){}
+public:
+	sim_bpred *clone(){return new static_predictor(*this);}
+};
+
+/* one 2-bit counter per branch address */
+class bimodal_predictor : public sim_bpred{
+	vector<unsigned char> counters;
+protected:
+	bool lookup(unsigned pc, unsigned long long history){return counters[(pc >> 2) % counters.size()] >= 2;}
+	void train(unsigned pc, bool taken, unsigned long long history){saturate(counters[(pc >> 2) % counters.size()], taken);}
+public:
+	bimodal_predictor(unsigned entries) : counters(entries, 1) {}
+	sim_bpred *clone(){return new bimodal_predictor(*this);}
+};
+
+/* 2-bit counters indexed by the branch address xor the global history */
+class gshare_predictor : public sim_bpred{
+	vector<unsigned char> counters;
+	unsigned long long history_mask;
+	unsigned index(unsigned pc, unsigned long long history){return ((pc >> 2) ^ (history & history_mask)) % counters.size();}
+protected:
+	bool lookup(unsigned pc, unsigned long long history){return counters[index(pc, history)] >= 2;}
+	void train(unsigned pc, bool taken, unsigned long long history){saturate(counters[index(pc, history)], taken);}
+public:
+	gshare_predictor(unsigned entries, unsigned history_bits) : counters(entries, 1){
+		history_mask = history_bits >= 64 ? ~0ULL : (1ULL << history_bits) - 1;
+	}
+	sim_bpred *clone(){return new gshare_predictor(*this);}
+};
+
+/* TAGE-lite: a bimodal base predictor and 4 tagged tables indexed with geometrically increasing
+   global history lengths; the longest matching table provides the prediction */
+class tage_predictor : public sim_bpred{
+	static const unsigned TABLES = 4;
+	typedef struct{
+		unsigned short tag;
+		signed char counter;	// 3-bit signed: taken if >= 0
+		unsigned char useful;	// 2-bit
+	} tage_entry_t;
+
+	vector<unsigned char> base;
+	vector<tage_entry_t> tables[TABLES];
+	unsigned lengths[TABLES];
+	unsigned index_bits;
+	unsigned long updates;
+
+	// the "length" most recent outcomes folded (xor) into "bits" bits
+	static unsigned fold(unsigned long long history, unsigned length, unsigned bits){
+		unsigned long long h = length >= 64 ? history : history & ((1ULL << length) - 1);
+		unsigned result = 0;
+		for (unsigned i = 0; i < length; i += bits) result ^= (unsigned)(h >> i);
+		return result & ((1u << bits) - 1);
+	}
+	unsigned index(unsigned t, unsigned pc, unsigned long long history){
+		return ((pc >> 2) ^ (pc >> (2 + index_bits)) ^ fold(history, lengths[t], index_bits)) % tables[t].size();
+	}
+	unsigned short tag(unsigned t, unsigned pc, unsigned long long history){
+		return (unsigned short)(((pc >> 2) ^ (fold(history, lengths[t], 8) << 1) ^ fold(history, lengths[t], 7)) & 0xFF);
+	}
+
+	// longest matching table (TABLES if none) and the prediction of the next one (or of the base table)
+	unsigned provider(unsigned pc, unsigned long long history, bool *alternate){
+		unsigned found = TABLES;
+		*alternate = base[(pc >> 2) % base.size()] >= 2;
+		for (unsigned t = 0; t < TABLES; t++){
+			tage_entry_t &e = tables[t][index(t, pc, history)];
+			if (e.tag != tag(t, pc, history)) continue;
+			if (found != TABLES) *alternate = tables[found][index(found, pc, history)].counter >= 0;
+			found = t;
+		}
+		return found;
+	}
+
+protected:
+	bool lookup(unsigned pc, unsigned long long history){
+		bool alternate;
+		unsigned t = provider(pc, history, &alternate);
+		return t == TABLES ? alternate : tables[t][index(t, pc, history)].counter >= 0;
+	}
+	void train(unsigned pc, bool taken, unsigned long long history){
+		bool alternate;
+		unsigned t = provider(pc, history, &alternate);
+		bool prediction = alternate;
+		if (t == TABLES) saturate(base[(pc >> 2) % base.size()], taken);
+		else{
+			tage_entry_t &e = tables[t][index(t, pc, history)];
+			prediction = e.counter >= 0;
+			if (prediction != alternate){
+				if (prediction == taken && e.useful < 3) e.useful++;
+				if (prediction != taken && e.useful > 0) e.useful--;
+			}
+			if (taken && e.counter < 3) e.counter++;
+			if (!taken && e.counter > -4) e.counter--;
+		}
+		// on a misprediction, allocate an entry in a table with a longer history
+		if (prediction != taken){
+			unsigned first = (t == TABLES) ? 0 : t + 1;
+			bool allocated = false;
+			for (unsigned i = first; i < TABLES && !allocated; i++){
+				tage_entry_t &e = tables[i][index(i, pc, history)];
+				if (e.useful != 0) continue;
+				e.tag = tag(i, pc, history);
+				e.counter = taken ? 0 : -1;
+				allocated = true;
+			}
+			if (!allocated)
+				for (unsigned i = first; i < TABLES; i++){
+					tage_entry_t &e = tables[i][index(i, pc, history)];
+					if (e.useful > 0) e.useful--;
+				}
+		}
+		// periodically age the useful counters so that stale entries can be replaced
+		if ((++updates & 0x3FFFF) == 0)
+			for (unsigned i = 0; i < TABLES; i++)
+				for (unsigned j = 0; j < tables[i].size(); j++) tables[i][j].useful >>= 1;
+	}
+
+public:
+	tage_predictor(unsigned entries, unsigned history_bits) : base(entries, 1){
+		index_bits = 0;
+		while ((1u << (index_bits + 1)) <= entries) index_bits++;
+		if (index_bits == 0) index_bits = 1;
+		tage_entry_t empty = {0xFFFF, 0, 0}; // 0xFFFF never matches an 8-bit tag
+		// history lengths: geometric series from (at most) 4 to history_bits
+		unsigned shortest = history_bits < 4 ? history_bits : 4;
+		double ratio = shortest == 0 ? 1 : pow((double)history_bits / shortest, 1.0 / (TABLES - 1));
+		double length = shortest;
+		for (unsigned t = 0; t < TABLES; t++){
+			tables[t].assign(entries, empty);
+			lengths[t] = length < 1 ? 1 : (unsigned)(length + 0.5);
+			length *= ratio;
+		}
+		updates = 0;
+	}
+	sim_bpred *clone(){return new tage_predictor(*this);}
+};
+
+sim_bpred *sim_bpred::create(branch_predictor_t type, unsigned entries, unsigned history_bits){
+	if (type != STATIC_NOT_TAKEN && entries == 0) throw sim_error("branch predictor must have at least one entry!");
+	if (history_bits > 64) throw sim_error("branch history cannot be longer than 64 bits!");
+	switch (type){
+		case STATIC_NOT_TAKEN: return new static_predictor();
+		case BIMODAL: return new bimodal_predictor(entries);
+		case GSHARE: return new gshare_predictor(entries, history_bits);
+		case TAGE_LITE: return new tage_predictor(entries, history_bits);
+	}
+	throw sim_error("unknown branch predictor!");
+}
+
+/* branch target buffer */
+
+sim_btb::sim_btb(){
+	entries = 0;
+	associativity = 1;
+	time = 0;
+}
+
+void sim_btb::init(unsigned entries, unsigned associativity){
+	if (entries == 0 || associativity == 0 || entries % associativity != 0)
+		throw sim_error("BTB entries must be a non-zero multiple of the associativity!");
+	this->entries = entries;
+	this->associativity = associativity;
+	pcs.assign(entries, UNDEFINED);
+	targets.assign(entries, UNDEFINED);
+	last_use.assign(entries, 0);
+	flush();
+}
+
+unsigned sim_btb::lookup(unsigned pc){
+	if (entries == 0) return UNDEFINED;
+	unsigned set = (pc >> 2) % (entries / associativity);
+	for (unsigned w = set * associativity; w < (set + 1) * associativity; w++){
+		if (pcs[w] != pc) continue;
+		last_use[w] = ++time;
+		return targets[w];
+	}
+	return UNDEFINED;
+}
+
+void sim_btb::update(unsigned pc, unsigned target){
+	if (entries == 0) return;
+	unsigned set = (pc >> 2) % (entries / associativity);
+	unsigned victim = set * associativity;
+	for (unsigned w = set * associativity; w < (set + 1) * associativity; w++){
+		if (pcs[w] == pc){
+			victim = w;
+			break;
+		}
+		if (pcs[w] == UNDEFINED || (pcs[victim] != UNDEFINED && last_use[w] < last_use[victim])) victim = w;
+	}
+	pcs[victim] = pc;
+	targets[victim] = target;
+	last_use[victim] = ++time;
+}
+
+void sim_btb::flush(){
+	for (unsigned i = 0; i < pcs.size(); i++) pcs[i] = UNDEFINED;
+	time = 0;
+}
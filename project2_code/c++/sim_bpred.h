@@ -0,0 +1,89 @@
+#ifndef SIM_BPRED_H_
+#define SIM_BPRED_H_
+
+#include <vector>
+
+using namespace std;
+
+// branch direction predictors
+typedef enum {STATIC_NOT_TAKEN, BIMODAL, GSHARE, TAGE_LITE} branch_predictor_t;
+
+// branch direction predictor
+// predict() is called when a conditional branch is fetched and update() when it commits, with its
+// outcome. The global history (gshare, TAGE-lite) is updated speculatively with the predictions;
+// each branch keeps the history it was predicted with, and recover() restores the history of the
+// committed branches after a flush.
+class sim_bpred{
+
+	unsigned long long speculative_history;
+	unsigned long long committed_history;
+
+protected:
+
+	//prediction/training of the tables for the branch at pc with the given global history
+	virtual bool lookup(unsigned pc, unsigned long long history) = 0;
+	virtual void train(unsigned pc, bool taken, unsigned long long history) = 0;
+
+public:
+	sim_bpred();
+	virtual ~sim_bpred() {}
+
+	//returns true if the branch at pc is predicted taken and shifts the prediction into the
+	//speculative history; *history is set to the history the branch was predicted with
+	bool predict(unsigned pc, unsigned long long *history);
+
+	//trains the predictor with the outcome of the branch at pc, predicted with the given history
+	void update(unsigned pc, bool taken, unsigned long long history);
+
+	//returns the speculative history (what the next prediction would use)
+	unsigned long long get_history();
+
+	//discards the speculative history of the branches not committed yet
+	void recover();
+
+	//restores the speculative history to "history" (after squashing the branches fetched later)
+	void recover(unsigned long long history);
+
+	//returns a copy of the predictor (same content)
+	virtual sim_bpred *clone() = 0;
+
+	//creates a predictor of the given type with "entries" counters (per table for TAGE-lite, which has
+	//a bimodal base table and 4 tagged tables) and history_bits bits of global history (gshare; the
+	//longest history of TAGE-lite, at most 64)
+	//throws sim_error on an invalid configuration
+	static sim_bpred *create(branch_predictor_t type, unsigned entries, unsigned history_bits);
+};
+
+// branch target buffer: set-associative, LRU replacement, holds the target of taken branches
+class sim_btb{
+
+	//configuration (entries = 0: BTB disabled)
+	unsigned entries;
+	unsigned associativity;
+
+	//content: per way, branch pc (UNDEFINED if invalid), target and last access time
+	vector<unsigned> pcs;
+	vector<unsigned> targets;
+	vector<unsigned long> last_use;
+	unsigned long time;
+
+public:
+
+	//creates a disabled BTB
+	sim_btb();
+
+	//configures the BTB (entries must be a multiple of associativity)
+	//throws sim_error on an invalid configuration
+	void init(unsigned entries, unsigned associativity);
+
+	//returns the target of the branch at pc (UNDEFINED on a miss)
+	unsigned lookup(unsigned pc);
+
+	//records the target of the taken branch at pc
+	void update(unsigned pc, unsigned target);
+
+	//invalidates all entries
+	void flush();
+};
+
+#endif /*SIM_BPRED_H_*/
@@ -0,0 +1,146 @@
+#include "sim_cache.h"
+#include "sim_ooo.h"
+#include <iomanip>
+
+using namespace std;
+
+sim_cache::sim_cache(unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency,
+		     replacement_t policy, unsigned mshrs){
+	if (!is_power_of_2(size) || !is_power_of_2(line_size) || associativity == 0 || line_size < 4 || hit_latency == 0
+	    || size % (line_size * associativity) != 0)
+		throw sim_error("invalid cache geometry!");
+	this->size = size;
+	this->associativity = associativity;
+	this->line_size = line_size;
+	this->hit_latency = hit_latency;
+	this->policy = policy;
+	this->mshrs = mshrs;
+	lines.resize(size / line_size);
+	flush();
+}
+
+unsigned sim_cache::find(unsigned line){
+	unsigned sets = lines.size() / associativity;
+	unsigned first = (line % sets) * associativity;
+	for (unsigned w=first; w<first+associativity; w++)
+		if (lines[w].valid && lines[w].tag == line) return w;
+	return UNDEFINED;
+}
+
+unsigned sim_cache::probe(unsigned address, bool write, unsigned now, bool *hit){
+	accesses++;
+	time++;
+	unsigned line = address / line_size;
+
+	// wait until the cache can accept the access
+	unsigned start = now;
+	if (mshrs == 0){
+		if (busy_until > start) start = busy_until;
+	}
+
+	unsigned way = find(line);
+	if (way != UNDEFINED){
+		*hit = true;
+		hits++;
+		if (policy == LRU) lines[way].stamp = time;
+		if (write) lines[way].dirty = true;
+		unsigned done = start + hit_latency;
+		if (lines[way].ready > done) done = lines[way].ready; // merged into the miss in flight
+		stall_cycles += start - now;
+		return done - now;
+	}
+
+	*hit = false;
+	misses++;
+	if (mshrs != 0){
+		// a free MSHR is needed: wait for the earliest outstanding miss otherwise
+		unsigned in_flight = 0, earliest = UNDEFINED;
+		for (unsigned i=0; i<mshr_ready.size(); ){
+			if (mshr_ready[i] <= now){ // completed: release the MSHR
+				mshr_ready[i] = mshr_ready.back();
+				mshr_ready.pop_back();
+				continue;
+			}
+			if (mshr_ready[i] > start) in_flight++;
+			if (mshr_ready[i] < earliest) earliest = mshr_ready[i];
+			i++;
+		}
+		if (in_flight >= mshrs) start = earliest;
+	}
+	stall_cycles += start - now;
+	miss_line = line;
+	return start + hit_latency - now;
+}
+
+void sim_cache::fill(unsigned address, bool write, unsigned ready){
+	unsigned line = address / line_size;
+	if (line != miss_line || find(line) != UNDEFINED) return;
+	unsigned sets = lines.size() / associativity;
+	unsigned first = (line % sets) * associativity;
+	unsigned victim = first;
+	for (unsigned w=first; w<first+associativity; w++){
+		if (!lines[w].valid){
+			victim = w;
+			break;
+		}
+		if (lines[w].stamp < lines[victim].stamp) victim = w;
+	}
+	if (policy == RANDOM && lines[victim].valid){
+		seed = seed * 1103515245 + 12345;
+		victim = first + (seed >> 16) % associativity;
+	}
+	if (lines[victim].valid && lines[victim].dirty) writebacks++;
+	lines[victim].tag = line;
+	lines[victim].valid = true;
+	lines[victim].dirty = write;
+	lines[victim].stamp = time;
+	lines[victim].ready = ready;
+
+	if (mshrs == 0) busy_until = ready;
+	else mshr_ready.push_back(ready);
+}
+
+void sim_cache::flush(){
+	for (unsigned i=0; i<lines.size(); i++){
+		lines[i].tag = UNDEFINED;
+		lines[i].valid = false;
+		lines[i].dirty = false;
+		lines[i].stamp = 0;
+		lines[i].ready = 0;
+	}
+	time = 0;
+	seed = 1;
+	mshr_ready.clear();
+	busy_until = 0;
+	miss_line = UNDEFINED;
+	accesses = 0;
+	hits = 0;
+	misses = 0;
+	writebacks = 0;
+	stall_cycles = 0;
+}
+
+unsigned sim_cache::get_accesses(){return accesses;}
+
+unsigned sim_cache::get_hits(){return hits;}
+
+unsigned sim_cache::get_misses(){return misses;}
+
+unsigned sim_cache::get_writebacks(){return writebacks;}
+
+unsigned sim_cache::get_stall_cycles(){return stall_cycles;}
+
+void sim_cache::print_stats(ostream &out){
+	const char *policy_names[] = {"LRU", "FIFO", "RANDOM"};
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << dec << size << "B " << associativity << "-way " << line_size << "B lines, "
+	    << hit_latency << " cycles, " << policy_names[policy] << ", ";
+	if (mshrs == 0) out << "blocking" << endl;
+	else out << mshrs << " MSHRs" << endl;
+	out << "  accesses: " << accesses << " hits: " << hits << " misses: " << misses;
+	if (accesses > 0) out << " (" << fixed << setprecision(2) << 100.0 * misses / accesses << "%)";
+	out << " writebacks: " << writebacks << " stall cycles: " << stall_cycles << endl;
+	out.flags(flags);
+	out.precision(precision);
+}
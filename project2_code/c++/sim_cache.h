@@ -0,0 +1,82 @@
+#ifndef SIM_CACHE_H_
+#define SIM_CACHE_H_
+
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+typedef enum {LRU, FIFO, RANDOM} replacement_t;
+
+// one level of a data cache hierarchy (write-back, write-allocate)
+// A blocking cache serves nothing else while a miss is outstanding; a non-blocking one keeps up
+// to "mshrs" misses in flight and merges accesses to a line that is still being filled.
+// Tags are updated when the miss is handled, and each line records the cycle its data arrives.
+class sim_cache{
+
+	typedef struct{
+		unsigned tag;
+		bool valid;
+		bool dirty;
+		unsigned long stamp;	// last use (LRU) or insertion (FIFO)
+		unsigned ready;		// cycle in which the data is available
+	} cache_line_t;
+
+	//configuration
+	unsigned size;
+	unsigned associativity;
+	unsigned line_size;
+	unsigned hit_latency;
+	replacement_t policy;
+	unsigned mshrs;		// 0 = blocking
+
+	//content
+	vector<cache_line_t> lines;
+	unsigned long time;
+	unsigned seed;		// random replacement (deterministic)
+
+	//outstanding misses: completion cycle of each miss in flight (blocking: busy_until)
+	vector<unsigned> mshr_ready;
+	unsigned busy_until;
+
+	//line of the last miss (to be filled by fill())
+	unsigned miss_line;
+
+	//statistics
+	unsigned accesses;
+	unsigned hits;
+	unsigned misses;
+	unsigned writebacks;
+	unsigned stall_cycles;	// cycles spent waiting for the cache to accept an access
+
+	//returns the way holding the line, or UNDEFINED
+	unsigned find(unsigned line);
+
+public:
+
+	//configures the cache; throws sim_error on an invalid geometry
+	//(size and line_size powers of 2, size a multiple of line_size*associativity, hit_latency at least 1)
+	sim_cache(unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency,
+		  replacement_t policy=LRU, unsigned mshrs=0);
+
+	//looks up the address at cycle "now"; sets "hit" and returns the cycles until the data is
+	//available (hit) or until the miss can be sent to the next level (miss)
+	unsigned probe(unsigned address, bool write, unsigned now, bool *hit);
+
+	//allocates the line of the last missing access, whose data arrives at cycle "ready"
+	void fill(unsigned address, bool write, unsigned ready);
+
+	//invalidates all lines and clears the statistics
+	void flush();
+
+	unsigned get_accesses();
+	unsigned get_hits();
+	unsigned get_misses();
+	unsigned get_writebacks();
+	unsigned get_stall_cycles();
+
+	//prints the configuration and statistics of the cache
+	void print_stats(ostream &out=cout);
+};
+
+#endif /*SIM_CACHE_H_*/
@@ -0,0 +1,156 @@
+#include "sim_dram.h"
+#include "sim_ooo.h"
+#include <iomanip>
+
+using namespace std;
+
+sim_dram::sim_dram(){
+	channels = 0;
+	banks = 1;
+	row_size = 2048;
+	line_size = 64;
+	policy = OPEN_PAGE;
+	tRCD = tCAS = tRP = 0;
+	burst = 1;
+	queue_size = 1;
+	flush();
+}
+
+void sim_dram::init(unsigned channels, unsigned banks, unsigned row_size, row_policy_t policy,
+		    unsigned tRCD, unsigned tCAS, unsigned tRP, unsigned burst, unsigned line_size, unsigned queue_size){
+	if (!is_power_of_2(channels) || !is_power_of_2(banks) || !is_power_of_2(line_size) || !is_power_of_2(row_size)
+	    || row_size < line_size || queue_size == 0 || tCAS == 0 || burst == 0)
+		throw sim_error("invalid DRAM configuration!");
+	this->channels = channels;
+	this->banks = banks;
+	this->row_size = row_size;
+	this->policy = policy;
+	this->tRCD = tRCD;
+	this->tCAS = tCAS;
+	this->tRP = tRP;
+	this->burst = burst;
+	this->line_size = line_size;
+	this->queue_size = queue_size;
+	flush();
+}
+
+bool sim_dram::enabled(){return channels != 0;}
+
+unsigned sim_dram::enqueue(unsigned address, unsigned arrival){
+	// line -> channel | column | bank | row
+	unsigned line = address / line_size;
+	unsigned channel = line % channels;
+	line /= channels;
+	line /= row_size / line_size;
+	dram_request_t request;
+	request.id = next_id++;
+	request.address = address;
+	request.bank = line % banks;
+	request.row = line / banks;
+	request.arrival = arrival;
+	queues[channel].push_back(request);
+	if (requests == 0 || arrival < first_cycle) first_cycle = arrival;
+	requests++;
+	return request.id;
+}
+
+void sim_dram::tick(unsigned now, vector<dram_completion_t> &issued){
+	for (unsigned c=0; c<channels; c++){
+		deque<dram_request_t> &queue = queues[c];
+		unsigned window = queue.size() < queue_size ? queue.size() : queue_size;
+
+		// FR-FCFS: oldest row hit to an idle bank first, then oldest request to an idle bank
+		unsigned chosen = UNDEFINED;
+		for (unsigned i=0; i<window; i++){
+			dram_request_t &r = queue[i];
+			dram_bank_t &bank = bank_state[c * banks + r.bank];
+			if (r.arrival > now || bank.ready > now) continue;
+			if (bank.open_row == r.row){
+				chosen = i;
+				break;
+			}
+			if (chosen == UNDEFINED) chosen = i;
+		}
+		if (chosen == UNDEFINED) continue;
+
+		dram_request_t r = queue[chosen];
+		queue.erase(queue.begin() + chosen);
+		dram_bank_t &bank = bank_state[c * banks + r.bank];
+		unsigned access;
+		if (bank.open_row == r.row){
+			row_hits++;
+			access = tCAS;
+		} else if (bank.open_row == UNDEFINED){
+			row_empty++;
+			access = tRCD + tCAS;
+		} else{
+			row_conflicts++;
+			access = tRP + tRCD + tCAS;
+		}
+		unsigned data = now + access;
+		if (bus_free[c] > data) data = bus_free[c];
+		bus_free[c] = data + burst;
+		bus_busy_cycles += burst;
+		if (policy == OPEN_PAGE){
+			bank.open_row = r.row;
+			bank.ready = now + access;
+		} else{
+			bank.open_row = UNDEFINED;
+			bank.ready = now + access + tRP;
+		}
+
+		dram_completion_t done = {r.id, r.address, data + burst};
+		issued.push_back(done);
+		total_latency += done.done - r.arrival;
+		if (done.done > last_cycle) last_cycle = done.done;
+	}
+}
+
+void sim_dram::flush(){
+	queues.assign(channels, deque<dram_request_t>());
+	dram_bank_t idle = {UNDEFINED, 0};
+	bank_state.assign(channels * banks, idle);
+	bus_free.assign(channels, 0);
+	next_id = 0;
+	requests = 0;
+	row_hits = 0;
+	row_empty = 0;
+	row_conflicts = 0;
+	total_latency = 0;
+	bus_busy_cycles = 0;
+	first_cycle = 0;
+	last_cycle = 0;
+}
+
+unsigned sim_dram::get_requests(){return requests;}
+
+unsigned sim_dram::get_row_hits(){return row_hits;}
+
+double sim_dram::get_row_hit_rate(){
+	unsigned served = row_hits + row_empty + row_conflicts;
+	return served == 0 ? 0 : (double)row_hits / served;
+}
+
+double sim_dram::get_bandwidth(){
+	unsigned served = row_hits + row_empty + row_conflicts;
+	if (served == 0 || last_cycle <= first_cycle) return 0;
+	return (double)served * line_size / (last_cycle - first_cycle);
+}
+
+void sim_dram::print_stats(ostream &out){
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	unsigned served = row_hits + row_empty + row_conflicts;
+	out << "DRAM: " << dec << channels << " channels x " << banks << " banks, " << row_size << "B rows, "
+	    << (policy == OPEN_PAGE ? "open" : "closed") << " page, tRCD-tCAS-tRP " << tRCD << "-" << tCAS << "-" << tRP
+	    << ", burst " << burst << endl;
+	out << "  requests: " << requests << " row hits: " << row_hits << " row empty: " << row_empty
+	    << " row conflicts: " << row_conflicts << fixed << setprecision(2);
+	if (served > 0) out << " (hit rate " << 100.0 * get_row_hit_rate() << "%, avg latency " << (double)total_latency / served << ")";
+	out << endl << "  bandwidth: " << get_bandwidth() << " B/cycle";
+	if (last_cycle > first_cycle)
+		out << " (data bus utilization " << 100.0 * bus_busy_cycles / ((double)(last_cycle - first_cycle) * channels) << "%)";
+	out << endl;
+	out.flags(flags);
+	out.precision(precision);
+}
@@ -0,0 +1,100 @@
+#ifndef SIM_DRAM_H_
+#define SIM_DRAM_H_
+
+#include <vector>
+#include <deque>
+#include <iostream>
+
+using namespace std;
+
+typedef enum {OPEN_PAGE, CLOSED_PAGE} row_policy_t;
+
+// DRAM main memory: channels of banks with row buffers, scheduled FR-FCFS
+// Consecutive lines are interleaved across channels, then across the columns of a row, then
+// across banks. Every cycle each channel issues at most one request, picking among the oldest
+// "queue_size" requests the oldest row hit to an idle bank, or else the oldest request to an
+// idle bank. Service time is tCAS for a row hit, tRCD+tCAS for a closed bank and tRP+tRCD+tCAS
+// for a row conflict; the line then occupies the channel data bus for "burst" cycles.
+// With CLOSED_PAGE the bank precharges after every access (tRP, off the critical path).
+class sim_dram{
+
+	typedef struct{
+		unsigned id;
+		unsigned address;
+		unsigned bank;		// bank index within the channel
+		unsigned row;
+		unsigned arrival;	// cycle from which the request can be scheduled
+	} dram_request_t;
+
+	typedef struct{
+		unsigned open_row;	// UNDEFINED if precharged
+		unsigned ready;		// cycle from which the bank accepts a new command
+	} dram_bank_t;
+
+	//configuration
+	unsigned channels;
+	unsigned banks;
+	unsigned row_size;
+	unsigned line_size;
+	row_policy_t policy;
+	unsigned tRCD, tCAS, tRP, burst;
+	unsigned queue_size;
+
+	//state
+	vector<deque<dram_request_t> > queues;	// per channel, in arrival order
+	vector<dram_bank_t> bank_state;		// channel * banks + bank
+	vector<unsigned> bus_free;		// per channel: cycle in which the data bus becomes free
+	unsigned next_id;
+
+	//statistics
+	unsigned requests;
+	unsigned row_hits;
+	unsigned row_empty;
+	unsigned row_conflicts;
+	unsigned long long total_latency;	// arrival to data transfer completion
+	unsigned bus_busy_cycles;
+	unsigned first_cycle, last_cycle;	// first arrival, last completion
+
+public:
+
+	//completion of a request, returned by tick()
+	typedef struct{
+		unsigned id;
+		unsigned address;
+		unsigned done;		// cycle in which the data transfer completes
+	} dram_completion_t;
+
+	//creates a DRAM that is not configured
+	sim_dram();
+
+	//configures the DRAM (channels, banks and row_size/line_size must be powers of 2, tCAS and burst at least 1)
+	//throws sim_error on an invalid configuration
+	void init(unsigned channels, unsigned banks, unsigned row_size, row_policy_t policy,
+		  unsigned tRCD, unsigned tCAS, unsigned tRP, unsigned burst, unsigned line_size, unsigned queue_size);
+
+	//true if the DRAM has been configured
+	bool enabled();
+
+	//queues a line request that can be scheduled from cycle "arrival"; returns its id
+	unsigned enqueue(unsigned address, unsigned arrival);
+
+	//schedules the requests of cycle "now"; appends the requests issued (with their completion cycle)
+	void tick(unsigned now, vector<dram_completion_t> &issued);
+
+	//drops all requests, closes all rows and clears the statistics
+	void flush();
+
+	unsigned get_requests();
+	unsigned get_row_hits();
+
+	//returns the row-buffer hit rate
+	double get_row_hit_rate();
+
+	//returns the average bandwidth in bytes per cycle between the first request and the last completion
+	double get_bandwidth();
+
+	//prints the configuration and statistics
+	void print_stats(ostream &out=cout);
+};
+
+#endif /*SIM_DRAM_H_*/
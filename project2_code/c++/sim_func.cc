@@ -0,0 +1,136 @@
+#include "sim_func.h"
+
+using namespace std;
+
+/* =============================================================
+
+   FUNCTIONAL MODEL
+
+   ============================================================= */
+
+sim_func::sim_func(const instruction_t *program, unsigned base_address, const unsigned *registers,
+		   const sim_memory &data_memory, unsigned queue_size)
+	: data_memory(data_memory), trace(queue_size){
+	for (unsigned i=0; i<PROGRAM_SIZE; i++) this->program[i] = program[i];
+	this->base_address = base_address;
+	for (unsigned i=0; i<NUM_GP_REGISTERS*2; i++) this->registers[i] = registers[i];
+	pc = base_address;
+	stop = false;
+	done = false;
+	started = false;
+}
+
+sim_func::~sim_func(){
+	if (started){
+		stop = true;
+		producer.join();
+	}
+}
+
+bool sim_func::step(dyn_instr_t *instr){
+	unsigned index = (pc - base_address) >> 2;
+	if (index >= PROGRAM_SIZE) return false;
+	instruction_t &inst = program[index];
+	if (inst.opcode == EOP) return false;
+
+	dyn_instr_t d;
+	d.pc = pc;
+	d.opcode = inst.opcode;
+	d.value1 = UNDEFINED;
+	d.value2 = UNDEFINED;
+	d.address = UNDEFINED;
+	d.result = UNDEFINED;
+	d.taken = false;
+
+	unsigned next_pc = pc + 4;
+	switch (inst.opcode){
+		case LW:
+		case LWS:
+			d.value1 = registers[inst.src1];
+			d.address = inst.immediate + d.value1;
+			if (!data_memory.contains(d.address, 4)) throw sim_error("load outside of data memory!");
+			d.result = data_memory.read_word(d.address);
+			registers[inst.dest + (inst.opcode == LWS ? NUM_GP_REGISTERS : 0)] = d.result;
+			break;
+		case SW:
+		case SWS:
+			d.value1 = registers[inst.src1 + (inst.opcode == SWS ? NUM_GP_REGISTERS : 0)];
+			d.value2 = registers[inst.src2];
+			d.address = inst.immediate + d.value2;
+			if (!data_memory.contains(d.address, 4)) throw sim_error("store outside of data memory!");
+			d.result = d.value1;
+			data_memory.write_word(d.address, d.result);
+			break;
+		case ADDI:
+		case SUBI:
+			d.value1 = registers[inst.src1];
+			d.value2 = inst.immediate;
+			d.result = alu(inst.opcode, d.value1, d.value2, inst.immediate, pc);
+			registers[inst.dest] = d.result;
+			break;
+		case ADD:
+		case SUB:
+		case XOR:
+		case AND:
+		case MULT:
+		case DIV:
+			d.value1 = registers[inst.src1];
+			d.value2 = registers[inst.src2];
+			if (inst.opcode == DIV && d.value2 == 0) throw sim_error("integer division by zero!");
+			d.result = alu(inst.opcode, d.value1, d.value2, inst.immediate, pc);
+			registers[inst.dest] = d.result;
+			break;
+		case ADDS:
+		case SUBS:
+		case MULTS:
+		case DIVS:
+			d.value1 = registers[inst.src1 + NUM_GP_REGISTERS];
+			d.value2 = registers[inst.src2 + NUM_GP_REGISTERS];
+			d.result = alu(inst.opcode, d.value1, d.value2, inst.immediate, pc);
+			registers[inst.dest + NUM_GP_REGISTERS] = d.result;
+			break;
+		case JUMP:
+			d.result = alu(inst.opcode, 0, 0, inst.immediate, pc);
+			d.taken = true;
+			next_pc = d.result;
+			break;
+		default: // conditional branches
+			d.value1 = registers[inst.src1];
+			d.result = alu(inst.opcode, d.value1, 0, inst.immediate, pc);
+			d.taken = (d.result != pc + 4);
+			next_pc = d.result;
+			break;
+	}
+	pc = next_pc;
+	*instr = d;
+	return true;
+}
+
+void sim_func::produce(){
+	dyn_instr_t d;
+	try{
+		while (!stop && step(&d)){
+			while (!trace.push(d)){
+				if (stop) return;
+				this_thread::yield();
+			}
+		}
+	} catch (const sim_error &e){
+		// the timing model falls back to its own values once the stream ends
+	}
+	done = true;
+}
+
+void sim_func::start(){
+	if (started) return;
+	started = true;
+	producer = thread(&sim_func::produce, this);
+}
+
+bool sim_func::next(dyn_instr_t *instr){
+	while (!trace.pop(*instr)){
+		if (done) return trace.pop(*instr);
+		this_thread::yield();
+	}
+	return true;
+}
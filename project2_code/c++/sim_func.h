@@ -0,0 +1,59 @@
+#ifndef SIM_FUNC_H_
+#define SIM_FUNC_H_
+
+#include "sim_ooo.h"
+#include "spsc_ring.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+// functional model: executes the program architecturally, one instruction at a time, and
+// (once started) streams the resulting dynamic instructions to the timing model through a
+// lock-free ring filled by a producer thread
+class sim_func{
+
+	//program
+	instruction_t program[PROGRAM_SIZE];
+	unsigned base_address;
+
+	//architectural state (raw register bits: 0-31 integer, 32-63 floating point)
+	unsigned registers[NUM_GP_REGISTERS * 2];
+	sim_memory data_memory;
+	unsigned pc;
+
+	//dynamic instruction stream
+	spsc_ring<dyn_instr_t> trace;
+	thread producer;
+	atomic<bool> stop;	// set by the consumer to terminate the producer
+	atomic<bool> done;	// set by the producer at the end of the program (or on error)
+	bool started;
+
+	//producer thread body
+	void produce();
+
+	sim_func(const sim_func &);
+	sim_func &operator=(const sim_func &);
+
+public:
+
+	//copies the program and the initial architectural state
+	sim_func(const instruction_t *program, unsigned base_address, const unsigned *registers,
+		 const sim_memory &data_memory, unsigned queue_size=4096);
+
+	//stops the producer thread (if running) and de-allocates the model
+	~sim_func();
+
+	//executes the next instruction; returns false (and leaves "instr" untouched) at the end of the program
+	//throws sim_error on an out-of-range data memory access
+	bool step(dyn_instr_t *instr);
+
+	//starts the producer thread
+	void start();
+
+	//returns the next dynamic instruction produced by the producer thread, waiting for it if needed;
+	//returns false once the program has ended
+	bool next(dyn_instr_t *instr);
+};
+
+#endif /*SIM_FUNC_H_*/
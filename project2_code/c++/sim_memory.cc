@@ -0,0 +1,192 @@
+#include "sim_memory.h"
+#include "sim_ooo.h"
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+#define PAGE_INDEX(address) (((address) >> MEMORY_PAGE_BITS) & ((1u << MEMORY_TABLE_BITS) - 1))
+#define TABLE_INDEX(address) ((address) >> (MEMORY_PAGE_BITS + MEMORY_TABLE_BITS))
+#define PAGE_OFFSET(address) ((address) & (MEMORY_PAGE_SIZE - 1))
+
+sim_memory::sim_memory(unsigned size){
+	this->size = size == 0 ? (1ull << 32) : size;
+	for (unsigned i=0; i<MEMORY_DIRECTORY_SIZE; i++) directory[i] = NULL;
+}
+
+sim_memory::sim_memory(const sim_memory &other){
+	size = other.size;
+	for (unsigned i=0; i<MEMORY_DIRECTORY_SIZE; i++) directory[i] = NULL;
+	sim_memory &source = const_cast<sim_memory &>(other);
+	lock_guard<mutex> guard(source.lock);
+	for (unsigned i=0; i<source.touched.size(); i++){
+		unsigned address = source.touched[i] << MEMORY_PAGE_BITS;
+		memcpy(get_page(address, true), source.lookup_page(address), MEMORY_PAGE_SIZE);
+	}
+	for (unsigned i=0; i<source.mapped.size(); i++){
+		unsigned address = source.mapped[i] << MEMORY_PAGE_BITS;
+		memcpy(get_page(address, true), source.lookup_page(address), MEMORY_PAGE_SIZE);
+	}
+}
+
+sim_memory::~sim_memory(){
+	clear();
+}
+
+unsigned char *sim_memory::get_page(unsigned address, bool allocate){
+	unsigned char *page = lookup_page(address);
+	if (page != NULL || !allocate) return page;
+
+	// first write to the page: allocate it, checking again under the lock
+	lock_guard<mutex> guard(lock);
+	return install_page(address, NULL);
+}
+
+unsigned char *sim_memory::install_page(unsigned address, unsigned char *image_page){
+	page_ptr_t *table = directory[TABLE_INDEX(address)].load(memory_order_relaxed);
+	if (table == NULL){
+		table = new page_ptr_t[1u << MEMORY_TABLE_BITS];
+		for (unsigned i=0; i<(1u << MEMORY_TABLE_BITS); i++) table[i] = NULL;
+		directory[TABLE_INDEX(address)].store(table, memory_order_release);
+	}
+	unsigned char *page = table[PAGE_INDEX(address)].load(memory_order_relaxed);
+	if (page != NULL) return page;
+	if (image_page != NULL){
+		page = image_page;
+		mapped.push_back(address >> MEMORY_PAGE_BITS);
+	} else{
+		page = new unsigned char[MEMORY_PAGE_SIZE];
+		memset(page, 0xFF, MEMORY_PAGE_SIZE);
+		touched.push_back(address >> MEMORY_PAGE_BITS);
+	}
+	table[PAGE_INDEX(address)].store(page, memory_order_release);
+	return page;
+}
+
+unsigned long long sim_memory::get_size() const{return size;}
+
+bool sim_memory::contains(unsigned address, unsigned bytes) const{
+	return (unsigned long long)address + bytes <= size;
+}
+
+unsigned char sim_memory::read_byte(unsigned address){
+	unsigned char *page = lookup_page(address);
+	return page == NULL ? 0xFF : page[PAGE_OFFSET(address)];
+}
+
+void sim_memory::write_byte(unsigned address, unsigned char value){
+	get_page(address, true)[PAGE_OFFSET(address)] = value;
+}
+
+void sim_memory::read_block(unsigned address, void *data, unsigned length){
+	unsigned char *bytes = (unsigned char *)data;
+	while (length > 0){
+		unsigned chunk = MEMORY_PAGE_SIZE - PAGE_OFFSET(address);
+		if (chunk > length) chunk = length;
+		unsigned char *page = lookup_page(address);
+		if (page == NULL) memset(bytes, 0xFF, chunk);
+		else memcpy(bytes, page + PAGE_OFFSET(address), chunk);
+		bytes += chunk;
+		address += chunk;
+		length -= chunk;
+	}
+}
+
+void sim_memory::write_block(unsigned address, const void *data, unsigned length){
+	const unsigned char *bytes = (const unsigned char *)data;
+	while (length > 0){
+		unsigned chunk = MEMORY_PAGE_SIZE - PAGE_OFFSET(address);
+		if (chunk > length) chunk = length;
+		memcpy(get_page(address, true) + PAGE_OFFSET(address), bytes, chunk);
+		bytes += chunk;
+		address += chunk;
+		length -= chunk;
+	}
+}
+
+void sim_memory::map_image(const char *filename, unsigned base_address){
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) throw sim_error(string("open file ") + filename + " failed!");
+	struct stat info;
+	if (fstat(fd, &info) != 0){
+		close(fd);
+		throw sim_error(string("cannot read the size of ") + filename + "!");
+	}
+	if ((unsigned long long)info.st_size > size || !contains(base_address, info.st_size)){
+		close(fd);
+		throw sim_error(string("memory image ") + filename + " does not fit in data memory!");
+	}
+	size_t length = info.st_size;
+	if (length == 0){
+		close(fd);
+		return;
+	}
+	void *image = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED) throw sim_error(string("mapping of ") + filename + " failed!");
+
+	lock_guard<mutex> guard(lock);
+	unsigned mapped_before = mapped.size();
+	unsigned char *bytes = (unsigned char *)image;
+	for (size_t offset = 0; offset < length; ){
+		unsigned address = base_address + offset;
+		size_t chunk = MEMORY_PAGE_SIZE - PAGE_OFFSET(address);
+		if (chunk > length - offset) chunk = length - offset;
+		// whole pages use the mapping in place, partial or already written ones get a copy
+		unsigned char *page = install_page(address, chunk == MEMORY_PAGE_SIZE ? bytes + offset : NULL);
+		if (page != bytes + offset) memcpy(page + PAGE_OFFSET(address), bytes + offset, chunk);
+		offset += chunk;
+	}
+	if (mapped.size() == mapped_before) munmap(image, length);
+	else images.push_back(make_pair(image, length));
+}
+
+void sim_memory::dump_image(const char *filename, unsigned start_address, unsigned end_address){
+	if (end_address < start_address || !contains(start_address, end_address - start_address))
+		throw sim_error("invalid data memory range!");
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL) throw sim_error(string("open file ") + filename + " failed!");
+	unsigned char blank[MEMORY_PAGE_SIZE];
+	memset(blank, 0xFF, MEMORY_PAGE_SIZE);
+	bool failed = false;
+	for (unsigned address = start_address; address < end_address && !failed; ){
+		unsigned chunk = MEMORY_PAGE_SIZE - PAGE_OFFSET(address);
+		if (chunk > end_address - address) chunk = end_address - address;
+		unsigned char *page = lookup_page(address);
+		failed = fwrite(page == NULL ? blank : page + PAGE_OFFSET(address), 1, chunk, file) != chunk;
+		address += chunk;
+		if (address == 0) break; // wrapped around the end of the address space
+	}
+	if (fclose(file) != 0 || failed) throw sim_error(string("write of ") + filename + " failed!");
+}
+
+void sim_memory::clear(){
+	lock_guard<mutex> guard(lock);
+	for (unsigned i=0; i<touched.size(); i++){
+		unsigned address = touched[i] << MEMORY_PAGE_BITS;
+		page_ptr_t &entry = directory[TABLE_INDEX(address)].load(memory_order_relaxed)[PAGE_INDEX(address)];
+		delete [] entry.load(memory_order_relaxed);
+		entry.store(NULL, memory_order_relaxed);
+	}
+	touched.clear();
+	for (unsigned i=0; i<mapped.size(); i++){
+		unsigned address = mapped[i] << MEMORY_PAGE_BITS;
+		directory[TABLE_INDEX(address)].load(memory_order_relaxed)[PAGE_INDEX(address)].store(NULL, memory_order_relaxed);
+	}
+	mapped.clear();
+	for (unsigned i=0; i<images.size(); i++) munmap(images[i].first, images[i].second);
+	images.clear();
+	for (unsigned i=0; i<MEMORY_DIRECTORY_SIZE; i++){
+		delete [] directory[i].load(memory_order_relaxed);
+		directory[i].store(NULL, memory_order_relaxed);
+	}
+}
+
+unsigned sim_memory::get_touched_pages(){
+	lock_guard<mutex> guard(lock);
+	return touched.size() + mapped.size();
+}
@@ -0,0 +1,144 @@
+#ifndef SIM_MEMORY_H_
+#define SIM_MEMORY_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include <string.h>
+
+using namespace std;
+
+#define MEMORY_PAGE_BITS 12			// 4KB pages
+#define MEMORY_PAGE_SIZE (1u << MEMORY_PAGE_BITS)
+#define MEMORY_TABLE_BITS 10			// pages per second-level table (1024)
+#define MEMORY_DIRECTORY_SIZE (1u << (32 - MEMORY_PAGE_BITS - MEMORY_TABLE_BITS))
+
+// little-endian 32-bit access to a byte buffer (memcpy compiles to a single load/store)
+inline unsigned load_le32(const unsigned char *buffer){
+	unsigned value;
+	memcpy(&value, buffer, sizeof value);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap32(value);
+#endif
+	return value;
+}
+
+inline void store_le32(unsigned char *buffer, unsigned value){
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	value = __builtin_bswap32(value);
+#endif
+	memcpy(buffer, &value, sizeof value);
+}
+
+// sparse data memory covering (up to) the whole 32-bit address space
+// Backed by a two-level page table of lazily allocated 4KB pages: a page reads as all 0xFF
+// until its first write, so creating and clearing the memory cost O(pages touched).
+// Pages are allocated under a lock, while lookups are lock-free, so one memory can be
+// shared by simulators running on different threads.
+// Binary images are mapped copy-on-write: their pages point straight into the mapping
+// (writes go to private copies made by the OS, never to the file).
+class sim_memory{
+
+	typedef atomic<unsigned char *> page_ptr_t;
+
+	//page directory: second-level tables of page pointers (NULL if never written)
+	atomic<page_ptr_t *> directory[MEMORY_DIRECTORY_SIZE];
+
+	//pages allocated so far and pages pointing into a mapped image (page numbers), protected by lock
+	vector<unsigned> touched;
+	vector<unsigned> mapped;
+	mutex lock;
+
+	//mapped images (start, length)
+	vector<pair<void *, size_t> > images;
+
+	//size in bytes (addresses beyond it are out of range)
+	unsigned long long size;
+
+	//returns the page containing the address (NULL if not allocated), without locking
+	unsigned char *lookup_page(unsigned address) const;
+
+	//returns the page containing the address (NULL if not allocated and "allocate" is false)
+	unsigned char *get_page(unsigned address, bool allocate);
+
+	//returns the page containing the address, installing "image_page" (or, if NULL, a new page)
+	//if there is none yet; the caller must hold the lock
+	unsigned char *install_page(unsigned address, unsigned char *image_page);
+
+	sim_memory &operator=(const sim_memory &);
+
+public:
+
+	//instantiates a memory of "size" bytes (0 = the whole 32-bit address space), all 0xFF
+	sim_memory(unsigned size=0);
+
+	//copies the pages written in another memory
+	sim_memory(const sim_memory &other);
+
+	//de-allocates the pages
+	~sim_memory();
+
+	//returns the size in bytes
+	unsigned long long get_size() const;
+
+	//returns true if the "bytes" bytes starting at "address" are in range
+	bool contains(unsigned address, unsigned bytes) const;
+
+	//byte access (no range check)
+	unsigned char read_byte(unsigned address);
+	void write_byte(unsigned address, unsigned char value);
+
+	//32-bit little-endian access (no range check)
+	unsigned read_word(unsigned address);
+	void write_word(unsigned address, unsigned value);
+
+	//copies "length" bytes between the memory and a buffer, memcpy-style (no range check)
+	void read_block(unsigned address, void *data, unsigned length);
+	void write_block(unsigned address, const void *data, unsigned length);
+
+	//maps the binary file "filename" copy-on-write at the given address
+	//(zero-copy for the pages it covers completely, if they were never written before)
+	//throws sim_error if the file cannot be mapped or does not fit in memory
+	void map_image(const char *filename, unsigned base_address);
+
+	//writes the bytes in [start_address, end_address) to the binary file "filename"
+	//throws sim_error if the file cannot be written or the range is invalid
+	void dump_image(const char *filename, unsigned start_address, unsigned end_address);
+
+	//sets all the memory back to 0xFF, releasing the pages and unmapping the images
+	void clear();
+
+	//returns the number of pages allocated
+	unsigned get_touched_pages();
+};
+
+inline unsigned char *sim_memory::lookup_page(unsigned address) const{
+	page_ptr_t *table = directory[address >> (MEMORY_PAGE_BITS + MEMORY_TABLE_BITS)].load(memory_order_acquire);
+	if (table == NULL) return NULL;
+	return table[(address >> MEMORY_PAGE_BITS) & ((1u << MEMORY_TABLE_BITS) - 1)].load(memory_order_acquire);
+}
+
+inline unsigned sim_memory::read_word(unsigned address){
+	unsigned offset = address & (MEMORY_PAGE_SIZE - 1);
+	if (offset > MEMORY_PAGE_SIZE - 4){ // crosses a page boundary
+		unsigned char buffer[4];
+		read_block(address, buffer, 4);
+		return load_le32(buffer);
+	}
+	unsigned char *page = lookup_page(address);
+	return page == NULL ? 0xFFFFFFFF : load_le32(page + offset);
+}
+
+inline void sim_memory::write_word(unsigned address, unsigned value){
+	unsigned offset = address & (MEMORY_PAGE_SIZE - 1);
+	if (offset > MEMORY_PAGE_SIZE - 4){ // crosses a page boundary
+		unsigned char buffer[4];
+		store_le32(buffer, value);
+		write_block(address, buffer, 4);
+		return;
+	}
+	store_le32(get_page(address, true) + offset, value);
+}
+
+#endif /*SIM_MEMORY_H_*/
@@ -0,0 +1,144 @@
+#include "sim_multicore.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+using namespace std;
+
+/* =============================================================
+
+   Multicore creation, initialization and deallocation
+
+   ============================================================= */
+
+sim_multicore::sim_multicore(unsigned mem_size, unsigned quantum) : data_memory(mem_size){
+	this->quantum = quantum == 0 ? 1 : quantum;
+	clock_cycles = 0;
+}
+
+sim_multicore::~sim_multicore(){
+	for (unsigned i=0; i<cores.size(); i++) delete cores[i];
+}
+
+unsigned sim_multicore::add_core(unsigned rob_size,
+				 unsigned num_int_res_stations,
+				 unsigned num_add_res_stations,
+				 unsigned num_mul_res_stations,
+				 unsigned num_load_buffers,
+				 unsigned issue_width,
+				 unsigned commit_width){
+	sim_ooo *core = new sim_ooo(0, rob_size, num_int_res_stations, num_add_res_stations,
+				    num_mul_res_stations, num_load_buffers, issue_width, commit_width);
+	core->attach_data_memory(&data_memory);
+	cores.push_back(core);
+	return cores.size()-1;
+}
+
+sim_ooo &sim_multicore::get_core(unsigned core){return *cores[core];}
+
+unsigned sim_multicore::get_num_cores(){return cores.size();}
+
+void sim_multicore::set_quantum(unsigned cycles){quantum = cycles == 0 ? 1 : cycles;}
+
+bool sim_multicore::is_finished(){
+	for (unsigned i=0; i<cores.size(); i++)
+		if (!cores[i]->is_finished()) return false;
+	return true;
+}
+
+unsigned sim_multicore::get_clock_cycles(){return clock_cycles;}
+
+void sim_multicore::reset(){
+	data_memory.clear();
+	for (unsigned i=0; i<cores.size(); i++) cores[i]->reset();
+	clock_cycles = 0;
+}
+
+void sim_multicore::write_memory(unsigned address, unsigned value){
+	if (!data_memory.contains(address, 4)) throw sim_error("write outside of data memory!");
+	data_memory.write_word(address, value);
+}
+
+void sim_multicore::write_memory_block(unsigned address, const void *data, unsigned size){
+	if (!data_memory.contains(address, size)) throw sim_error("write outside of data memory!");
+	data_memory.write_block(address, data, size);
+}
+
+void sim_multicore::read_memory_block(unsigned address, void *data, unsigned size){
+	if (!data_memory.contains(address, size)) throw sim_error("read outside of data memory!");
+	data_memory.read_block(address, data, size);
+}
+
+void sim_multicore::load_memory_image(const char *filename, unsigned base_address){
+	data_memory.map_image(filename, base_address);
+}
+
+void sim_multicore::dump_memory_image(const char *filename, unsigned start_address, unsigned end_address){
+	data_memory.dump_image(filename, start_address, end_address);
+}
+
+void sim_multicore::print_memory(unsigned start_address, unsigned end_address, ostream &out){
+	if (cores.empty()) throw sim_error("multicore does not have any cores!");
+	cores[0]->print_memory(start_address, end_address, out); // all cores see the same memory
+}
+
+/* =============================================================
+
+   Quantum-synchronized execution
+
+   ============================================================= */
+
+void sim_multicore::run(unsigned cycles){
+	unsigned num_cores = cores.size();
+	if (num_cores == 0 || is_finished()) return;
+
+	// barrier state (protected by lock)
+	mutex lock;
+	condition_variable quantum_done;
+	unsigned arrived = 0;
+	unsigned generation = 0;
+	unsigned simulated = 0;
+	unsigned step = (cycles != 0 && cycles < quantum) ? cycles : quantum;
+	bool stop = false;
+	bool failed = false;
+	string error;
+
+	vector<thread> threads;
+	for (unsigned c=0; c<num_cores; c++){
+		threads.push_back(thread([&, c](){
+			while (true){
+				unsigned this_step;
+				{
+					lock_guard<mutex> guard(lock);
+					this_step = step;
+				}
+				try{
+					cores[c]->run(this_step);
+				} catch (const sim_error &e){
+					lock_guard<mutex> guard(lock);
+					if (!failed){
+						failed = true;
+						error = e.what();
+					}
+				}
+
+				// barrier: the last core to arrive closes the quantum and plans the next one
+				unique_lock<mutex> guard(lock);
+				unsigned my_generation = generation;
+				if (++arrived == num_cores){
+					arrived = 0;
+					generation++;
+					simulated += step;
+					clock_cycles += step;
+					stop = failed || is_finished() || (cycles != 0 && simulated >= cycles);
+					if (cycles != 0 && cycles - simulated < quantum) step = cycles - simulated;
+					quantum_done.notify_all();
+				} else quantum_done.wait(guard, [&](){return generation != my_generation;});
+				if (stop) return;
+			}
+		}));
+	}
+	for (unsigned c=0; c<num_cores; c++) threads[c].join();
+
+	if (failed) throw sim_error(error);
+}
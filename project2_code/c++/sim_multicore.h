@@ -0,0 +1,88 @@
+#ifndef SIM_MULTICORE_H_
+#define SIM_MULTICORE_H_
+
+#include "sim_ooo.h"
+#include <vector>
+#include <iostream>
+
+using namespace std;
+
+// several out-of-order cores running separate programs against one shared data memory
+// Each core is simulated on its own host thread. The cores are synchronized by a conservative
+// quantum barrier: every core simulates "quantum" cycles, then waits for all the others.
+// Memory accesses of different cores within the same quantum are not ordered with respect to
+// each other, so communication through memory is only deterministic across quanta.
+class sim_multicore{
+
+	//shared data memory - initialized to all 0xFF
+	sim_memory data_memory;
+
+	//cores (each one keeps its own registers, program and statistics)
+	vector<sim_ooo *> cores;
+
+	//synchronization quantum (in clock cycles)
+	unsigned quantum;
+
+	//clock cycles simulated so far (multiple of the quantum, unless all cores have finished)
+	unsigned clock_cycles;
+
+	sim_multicore(const sim_multicore &);
+	sim_multicore &operator=(const sim_multicore &);
+
+public:
+
+	//instantiates an empty multicore with the given shared data memory size (in byte, 0 = whole 32-bit address space)
+	sim_multicore(unsigned mem_size, unsigned quantum=100);
+
+	//de-allocates the cores and the shared memory
+	~sim_multicore();
+
+	//adds a core (see sim_ooo::sim_ooo for the parameters) and returns its index
+	//execution units and program are set up through get_core()
+	unsigned add_core(unsigned rob_size,
+			  unsigned num_int_res_stations,
+			  unsigned num_add_res_stations,
+			  unsigned num_mul_res_stations,
+			  unsigned num_load_buffers,
+			  unsigned issue_width=1,
+			  unsigned commit_width=1);
+
+	//returns the given core
+	sim_ooo &get_core(unsigned core);
+
+	//returns the number of cores
+	unsigned get_num_cores();
+
+	//sets the synchronization quantum (in clock cycles)
+	void set_quantum(unsigned cycles);
+
+	//runs all cores for "cycles" clock cycles (until all programs complete if cycles=0)
+	//throws sim_error (after stopping all cores) if a core raises one
+	void run(unsigned cycles=0);
+
+	//returns true once every core has completed its program
+	bool is_finished();
+
+	//returns the number of clock cycles simulated
+	unsigned get_clock_cycles();
+
+	//resets all cores and the shared data memory
+	void reset();
+
+	//writes an integer value to the shared data memory at the specified address (little-endian)
+	void write_memory(unsigned address, unsigned value);
+
+	//copies a block of bytes to/from the shared data memory (see sim_ooo::write_memory_block)
+	void write_memory_block(unsigned address, const void *data, unsigned size);
+	void read_memory_block(unsigned address, void *data, unsigned size);
+
+	//maps a binary file into the shared data memory / writes an address range of it to a binary file
+	//(see sim_ooo::load_memory_image and sim_ooo::dump_memory_image)
+	void load_memory_image(const char *filename, unsigned base_address);
+	void dump_memory_image(const char *filename, unsigned start_address, unsigned end_address);
+
+	//prints the content of the shared data memory within the specified address range
+	void print_memory(unsigned start_address, unsigned end_address, ostream &out=cout);
+};
+
+#endif /*SIM_MULTICORE_H_*/
@@ -1,4 +1,5 @@
 #include "sim_ooo.h"
+#include "sim_func.h"
 #include <stdlib.h>
 #include <iostream>
 #include <fstream>
@@ -7,6 +8,7 @@
 #include <iomanip>
 #include <map>
 #include <vector>
+#include <algorithm>
 
 using namespace std;
 
@@ -36,18 +38,8 @@ inline float unsigned2float(unsigned value){
 	return result;
 }
 
-/* convert integer into array of unsigned char - little indian */
-inline void unsigned2char(unsigned value, unsigned char *buffer){
-        buffer[0] = value & 0xFF;
-        buffer[1] = (value >> 8) & 0xFF;
-        buffer[2] = (value >> 16) & 0xFF;
-        buffer[3] = (value >> 24) & 0xFF;
-}
-
-/* convert array of char into integer - little indian */
-inline unsigned char2unsigned(unsigned char *buffer){
-       return buffer[0] + (buffer[1] << 8) + (buffer[2] << 16) + (buffer[3] << 24);
-}
+// busy time of a memory unit waiting for a DRAM request (replaced once the request is scheduled)
+#define DRAM_PENDING 0x40000000
 
 /* the following six functions return the kind of the considered opcdoe */
 
@@ -59,6 +51,10 @@ bool is_memory(opcode_t opcode){
         return (opcode == LW || opcode == SW || opcode == LWS || opcode == SWS);
 }
 
+bool is_power_of_2(unsigned value){
+	return value != 0 && (value & (value - 1)) == 0;
+}
+
 bool is_int_r(opcode_t opcode){
         return (opcode == ADD || opcode == SUB || opcode == XOR || opcode == AND);
 }
@@ -83,6 +79,21 @@ void clean_rob(rob_entry_t *entry){
         entry->destination=UNDEFINED;
         entry->value=UNDEFINED;
 		entry->branch_taken = false;
+		entry->predicted_pc = UNDEFINED;
+		entry->branch_history = 0;
+		entry->mispredicted = false;
+		entry->redirected = false;
+		entry->fused = false;
+		entry->branch_target = UNDEFINED;
+		entry->store_committed = false;
+		entry->store_exit_cc = UNDEFINED;
+		entry->store_mem_unit_index = UNDEFINED;
+		entry->store_address = UNDEFINED;
+		entry->load_address = UNDEFINED;
+		entry->load_source = UNDEFINED;
+		entry->load_dependence = UNDEFINED;
+		entry->load_held = false;
+		entry->load_violated = false;
 }
 
 /* clears a reservation station */
@@ -94,8 +105,8 @@ void clean_res_station(res_station_entry_t *entry){
         entry->tag2=UNDEFINED;
         entry->destination=UNDEFINED;
         entry->address=UNDEFINED;
-		entry->instr_has_been_exed = false;
-		
+		entry->result = UNDEFINED;
+		entry->wr_cycle = UNDEFINED;
 }
 
 /* clears an entry if the instruction window */
@@ -107,6 +118,63 @@ void clean_instr_window(instr_window_entry_t *entry){
         entry->commit=UNDEFINED;
 }
 
+/* returns true if the instruction writes an integer register */
+bool writes_int_register(opcode_t opcode){
+	return (is_int(opcode) || opcode == MULT || opcode == DIV || opcode == LW);
+}
+
+/* returns true if the instruction writes a floating point register */
+bool writes_fp_register(opcode_t opcode){
+	return (is_fp_alu(opcode) || opcode == LWS);
+}
+
+/* returns the register slot (R0-R31, then F0-F31) the instruction writes, UNDEFINED if none */
+unsigned destination_slot(const instruction_t &instr){
+	if (writes_int_register(instr.opcode)) return instr.dest;
+	if (writes_fp_register(instr.opcode)) return instr.dest + NUM_GP_REGISTERS;
+	return UNDEFINED;
+}
+
+/* sets the register slots the instruction reads, in the order of its reservation station operands (UNDEFINED: none) */
+void source_slots(const instruction_t &instr, unsigned *slots){
+	slots[0] = slots[1] = UNDEFINED;
+	switch(instr.opcode){
+		case SW:
+		case SWS:
+			slots[0] = instr.src1 + (instr.opcode == SWS ? NUM_GP_REGISTERS : 0);
+			slots[1] = instr.src2;
+			break;
+		case JUMP:
+		case EOP:
+		case NOP:
+			break;
+		case LW:
+		case LWS:
+		case ADDI:
+		case SUBI:
+		case BEQZ:
+		case BNEZ:
+		case BLTZ:
+		case BGTZ:
+		case BLEZ:
+		case BGEZ:
+			slots[0] = instr.src1;
+			break;
+		default:
+			slots[0] = instr.src1 + (is_fp_alu(instr.opcode) ? NUM_GP_REGISTERS : 0);
+			slots[1] = instr.src2 + (is_fp_alu(instr.opcode) ? NUM_GP_REGISTERS : 0);
+			break;
+	}
+}
+
+/* returns the type of reservation station the instruction is issued to */
+res_station_t res_station_type(opcode_t opcode){
+	if (is_memory(opcode)) return LOAD_B;
+	if (opcode == ADDS || opcode == SUBS) return ADD_RS;
+	if (opcode == MULT || opcode == DIV || opcode == MULTS || opcode == DIVS) return MULT_RS;
+	return INTEGER_RS;
+}
+
 /* implements the ALU operation 
    NOTE: this function does not cover LOADS and STORES!
 */
@@ -167,9 +235,34 @@ unsigned alu(opcode_t opcode, unsigned value1, unsigned value2, unsigned immedia
 	return 	result;
 }
 
+void sim_ooo::attach_data_memory(sim_memory *memory){
+	if (owns_data_memory) delete data_memory;
+	data_memory = memory;
+	owns_data_memory = false;
+}
+
 /* writes the data memory at the specified address */
 void sim_ooo::write_memory(unsigned address, unsigned value){
-	unsigned2char(value,data_memory+address);
+	if (!data_memory->contains(address, 4)) throw sim_error("write outside of data memory!");
+	data_memory->write_word(address, value);
+}
+
+void sim_ooo::write_memory_block(unsigned address, const void *data, unsigned size){
+	if (!data_memory->contains(address, size)) throw sim_error("write outside of data memory!");
+	data_memory->write_block(address, data, size);
+}
+
+void sim_ooo::read_memory_block(unsigned address, void *data, unsigned size){
+	if (!data_memory->contains(address, size)) throw sim_error("read outside of data memory!");
+	data_memory->read_block(address, data, size);
+}
+
+void sim_ooo::load_memory_image(const char *filename, unsigned base_address){
+	data_memory->map_image(filename, base_address);
+}
+
+void sim_ooo::dump_memory_image(const char *filename, unsigned start_address, unsigned end_address){
+	data_memory->dump_image(filename, start_address, end_address);
 }
 
 /* =============================================================
@@ -179,25 +272,89 @@ void sim_ooo::write_memory(unsigned address, unsigned value){
    ============================================================= */
 
 /* initializes an execution unit */
-void sim_ooo::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances){
-        for (unsigned i=0; i<instances; i++){
-                exec_units[num_units].type = exec_unit;
-                exec_units[num_units].latency = latency;
-                exec_units[num_units].busy = 0;
-                exec_units[num_units].pc = UNDEFINED;
-				exec_units[num_units].result = UNDEFINED;
-				exec_units[num_units].released_this_cycle = false;
-                num_units++;
-        }
+void sim_ooo::init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances, unsigned initiation_interval){
+	if (initiation_interval > latency) initiation_interval = 0;
+	// an operation holds its entry until the clock cycle after its write result (latency + 1 cycles),
+	// and a pipelined unit starts one every initiation interval
+	unsigned entries = initiation_interval == 0 ? 1 : (latency + initiation_interval) / initiation_interval;
+	unsigned units = 0;
+	for (unsigned u=0; u<num_units; u++)
+		if (exec_units[u].pipeline == u) units++;
+	if (units + instances > MAX_UNITS || num_units + instances * entries > MAX_UNIT_ENTRIES) throw sim_error("too many execution units!");
+	for (unsigned i=0; i<instances; i++){
+		unsigned pipeline = num_units;
+		for (unsigned e=0; e<entries; e++){
+			exec_units[num_units].type = exec_unit;
+			exec_units[num_units].latency = latency;
+			exec_units[num_units].busy = 0;
+			exec_units[num_units].pc = UNDEFINED;
+			exec_units[num_units].rob_index = UNDEFINED;
+			exec_units[num_units].dram_request = UNDEFINED;
+			exec_units[num_units].initiation_interval = initiation_interval;
+			exec_units[num_units].pipeline = pipeline;
+			exec_units[num_units].started = UNDEFINED;
+			num_units++;
+		}
+	}
+}
+
+/* changes the latency of the units of a given type, retiming the operations they started in the last clock cycle */
+void sim_ooo::set_unit_latency(exe_unit_t exec_unit, unsigned latency){
+	for (unsigned u=0; u<num_units; u++){
+		if (exec_units[u].type != exec_unit) continue;
+		unsigned r = exec_units[u].rob_index;
+		if ((dispatched_units & (1u << u)) && r != UNDEFINED){
+			exec_units[u].busy = exec_units[u].busy + latency - exec_units[u].latency;
+			if (r == STORE_BUFFER_DRAIN){
+				for (unsigned i=0; i<store_buffer.size(); i++){
+					if (store_buffer[i].unit != u) continue;
+					store_buffer[i].done = store_buffer[i].done + latency - exec_units[u].latency;
+					if (store_buffer[i].done < clock_cycles) store_buffer.erase(store_buffer.begin() + i);
+					break;
+				}
+			}else if (rob.entries[r].store_committed){
+				rob.entries[r].store_exit_cc = rob.entries[r].store_exit_cc + latency - exec_units[u].latency;
+				// a 1-cycle memory write completes in the clock cycle of the commit
+				if (rob.entries[r].store_exit_cc < clock_cycles){
+					retire_head();
+					check_finished();
+				}
+			}else{
+				for (unsigned s=0; s<reservation_stations.num_entries; s++){
+					res_station_entry_t &entry = reservation_stations.entries[s];
+					if (entry.pc != UNDEFINED && entry.destination == r && entry.wr_cycle != UNDEFINED)
+						entry.wr_cycle = entry.wr_cycle + latency - exec_units[u].latency;
+				}
+			}
+		}
+		exec_units[u].latency = latency;
+	}
+}
+
+unsigned sim_ooo::get_unit_types(){
+	unsigned types = 0;
+	for (unsigned u=0; u<num_units; u++) types |= 1 << exec_units[u].type;
+	return types;
+}
+
+unsigned sim_ooo::get_dispatched_unit_types(){
+	unsigned types = 0;
+	for (unsigned u=0; u<num_units; u++)
+		if (dispatched_units & (1u << u)) types |= 1 << exec_units[u].type;
+	return types;
+}
+
+bool sim_ooo::unit_accepts(unsigned unit){
+	if (exec_units[unit].initiation_interval == 0) return true;
+	unsigned started = exec_units[exec_units[unit].pipeline].started;
+	return started == UNDEFINED || clock_cycles >= started + exec_units[unit].initiation_interval;
 }
 
 /* returns a free unit for that particular operation or UNDEFINED if no unit is currently available */
 unsigned sim_ooo::get_free_unit(opcode_t opcode){
-	if (num_units == 0){
-		cout << "ERROR:: simulator does not have any execution units!\n";
-		exit(-1);
-	}
+	if (num_units == 0) throw sim_error("simulator does not have any execution units!");
 	for (unsigned u=0; u<num_units; u++){
+		bool free = exec_units[u].rob_index == UNDEFINED && unit_accepts(u);
 		switch(opcode){
 			//Integer unit
 			case ADD:
@@ -213,38 +370,54 @@ unsigned sim_ooo::get_free_unit(opcode_t opcode){
 			case BLEZ:
 			case BGEZ:
 			case JUMP:
-				if (exec_units[u].type==INTEGER && exec_units[u].busy==0 && exec_units[u].pc==UNDEFINED) return u;
+				if (exec_units[u].type==INTEGER && free) return u;
 				break;
 			//memory unit
 			case LW:
 			case SW:
 			case LWS: 
 			case SWS:
-				if (exec_units[u].type==MEMORY && exec_units[u].busy==0 && exec_units[u].pc==UNDEFINED) return u;
+				if (exec_units[u].type==MEMORY && free) return u;
 				break;
 			// FP adder
 			case ADDS:
 			case SUBS:
-				if (exec_units[u].type==ADDER && exec_units[u].busy==0 && exec_units[u].pc==UNDEFINED) return u;
+				if (exec_units[u].type==ADDER && free) return u;
 				break;
 			// Multiplier
 			case MULT:
 			case MULTS:
-				if (exec_units[u].type==MULTIPLIER && exec_units[u].busy==0 && exec_units[u].pc==UNDEFINED) return u;
+				if (exec_units[u].type==MULTIPLIER && free) return u;
 				break;
 			// Divider
 			case DIV:
 			case DIVS:
-				if (exec_units[u].type==DIVIDER && exec_units[u].busy==0 && exec_units[u].pc==UNDEFINED) return u;
+				if (exec_units[u].type==DIVIDER && free) return u;
 				break;
 			default:
-				cout << "ERROR:: operations not requiring exec unit!\n";
-				exit(-1);
+				throw sim_error("operations not requiring exec unit!");
 		}
 	}
 	return UNDEFINED;
 }
 
+/* occupies unit u with the instruction in ROB entry rob_index, until "cycles" clock cycles after the current one */
+void sim_ooo::occupy_unit(unsigned u, unsigned rob_index, unsigned cycles, bool unit_bound){
+	exec_units[u].busy = cycles;
+	exec_units[u].pc = rob_index == STORE_BUFFER_DRAIN ? UNDEFINED : rob.entries[rob_index].pc;
+	exec_units[u].rob_index = rob_index;
+	if (exec_units[u].initiation_interval != 0) exec_units[exec_units[u].pipeline].started = clock_cycles;
+	if (unit_bound) dispatched_units |= 1u << u;
+}
+
+/* frees unit u */
+void sim_ooo::release_unit(unsigned u){
+	exec_units[u].busy = 0;
+	exec_units[u].pc = UNDEFINED;
+	exec_units[u].rob_index = UNDEFINED;
+	exec_units[u].dram_request = UNDEFINED;
+}
+
 
 
 /* ============================================================================
@@ -261,133 +434,180 @@ unsigned sim_ooo::get_free_unit(opcode_t opcode){
  
 
 /* prints the content of the data memory */
-void sim_ooo::print_memory(unsigned start_address, unsigned end_address){
-	cout << "DATA MEMORY[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
+void sim_ooo::print_memory(unsigned start_address, unsigned end_address, ostream &out){
+	out << "DATA MEMORY[0x" << hex << setw(8) << setfill('0') << start_address << ":0x" << hex << setw(8) << setfill('0') <<  end_address << "]" << endl;
 	for (unsigned i=start_address; i<end_address; i++){
-		if (i%4 == 0) cout << "0x" << hex << setw(8) << setfill('0') << i << ": "; 
-		cout << hex << setw(2) << setfill('0') << int(data_memory[i]) << " ";
+		if (i%4 == 0) out << "0x" << hex << setw(8) << setfill('0') << i << ": "; 
+		out << hex << setw(2) << setfill('0') << int(data_memory->read_byte(i)) << " ";
 		if (i%4 == 3){
-			cout << endl;
+			out << endl;
 		}
 	} 
 }
 
+/* prints the data TLB and cache statistics */
+void sim_ooo::print_cache_stats(ostream &out){
+	out << "CACHE STATISTICS" << endl;
+	if (dtlb.enabled()) out << "DTLB: accesses: " << dec << dtlb.get_accesses() << " misses: " << dtlb.get_misses() << endl;
+	for (unsigned i=0; i<dcache.size(); i++){
+		if (i == 0) out << "L1D: ";
+		else out << "L" << dec << i+1 << ": ";
+		dcache[i].print_stats(out);
+	}
+	if (dram.enabled()) dram.print_stats(out);
+	if (load_ports > 0){
+		ios::fmtflags flags = out.flags();
+		streamsize precision = out.precision();
+		out << "MEMORY PORTS: " << dec << load_ports << " load, " << store_ports << " store, " << num_banks << " banks x " << bank_interleave << "B" << endl;
+		out << "  load port utilization: " << fixed << setprecision(2) << 100.0 * get_load_port_utilization() << "%"
+		    << " store port utilization: " << 100.0 * get_store_port_utilization() << "%"
+		    << " port stalls: " << port_stalls << " bank conflicts: " << bank_conflicts << endl;
+		out.flags(flags);
+		out.precision(precision);
+	}
+}
+
+/* prints the branch prediction statistics */
+void sim_ooo::print_branch_stats(ostream &out){
+	static const char *names[] = {"static not-taken", "bimodal", "gshare", "TAGE-lite"};
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << "BRANCH PREDICTION: ";
+	if (bpred == NULL) out << "none (not taken, no BTB)" << endl;
+	else out << names[bpred_type] << ", " << dec << bpred_entries << " entries, " << bpred_history_bits << " history bits" << endl;
+	out << "  branches: " << dec << branches << " mispredictions: " << branch_mispredictions << " BTB misses: " << btb_misses
+	    << fixed << setprecision(2) << " accuracy: " << 100.0 * get_branch_accuracy() << "% MPKI: " << get_branch_mpki() << endl;
+	if (early_branch_resolution)
+		out << "  early redirects: " << dec << early_redirects << " (penalty " << redirect_penalty << ") redirect stalls: " << redirect_stalls << endl;
+	if (fetch_width != 0){
+		out << "  front end: width " << dec << fetch_width << " front-end stalls: " << frontend_stalls << " fetch bubbles: " << fetch_bubbles;
+		if (loop_buffer_size != 0)
+			out << " loop buffer: " << loop_buffer_fetches << "/" << fetched_instructions << " instructions ("
+			    << 100.0 * get_loop_buffer_coverage() << "%)";
+		out << endl;
+	}
+	if (macro_op_fusion)
+		out << "  macro-op fusion: fused pairs: " << dec << fused_pairs << " fusion rate: " << 100.0 * get_fusion_rate() << "%" << endl;
+	out.flags(flags);
+	out.precision(precision);
+}
+
 /* prints the value of the registers */
-void sim_ooo::print_registers(){
+void sim_ooo::print_registers(ostream &out){
         unsigned i;
-	cout << "GENERAL PURPOSE REGISTERS" << endl;
-	cout << setfill(' ') << setw(8) << "Register" << setw(22) << "Value" << setw(5) << "ROB" << endl;
+	out << "GENERAL PURPOSE REGISTERS" << endl;
+	out << setfill(' ') << setw(8) << "Register" << setw(22) << "Value" << setw(5) << "ROB" << endl;
         for (i=0; i< NUM_GP_REGISTERS; i++){
                 if (get_int_register_tag(i)!=UNDEFINED) 
-			cout << setfill(' ') << setw(7) << "R" << dec << i << setw(22) << "-" << setw(5) << get_int_register_tag(i) << endl;
+			out << setfill(' ') << setw(7) << "R" << dec << i << setw(22) << "-" << setw(5) << get_int_register_tag(i) << endl;
                 else if (get_int_register(i)!=(int)UNDEFINED) 
-			cout << setfill(' ') << setw(7) << "R" << dec << i << setw(11) << get_int_register(i) << hex << "/0x" << setw(8) << setfill('0') << get_int_register(i) << setfill(' ') << setw(5) << "-" << endl;
+			out << setfill(' ') << setw(7) << "R" << dec << i << setw(11) << get_int_register(i) << hex << "/0x" << setw(8) << setfill('0') << get_int_register(i) << setfill(' ') << setw(5) << "-" << endl;
         }
 	for (i=0; i< NUM_GP_REGISTERS; i++){
                 if (get_fp_register_tag(i)!=UNDEFINED) 
-			cout << setfill(' ') << setw(7) << "F" << dec << i << setw(22) << "-" << setw(5) << get_fp_register_tag(i) << endl;
+			out << setfill(' ') << setw(7) << "F" << dec << i << setw(22) << "-" << setw(5) << get_fp_register_tag(i) << endl;
                 else if (get_fp_register(i)!=UNDEFINED) 
-			cout << setfill(' ') << setw(7) << "F" << dec << i << setw(11) << get_fp_register(i) << hex << "/0x" << setw(8) << setfill('0') << float2unsigned(get_fp_register(i)) << setfill(' ') << setw(5) << "-" << endl;
+			out << setfill(' ') << setw(7) << "F" << dec << i << setw(11) << get_fp_register(i) << hex << "/0x" << setw(8) << setfill('0') << float2unsigned(get_fp_register(i)) << setfill(' ') << setw(5) << "-" << endl;
 	}
-	cout << endl;
+	out << endl;
 }
 
 /* prints the content of the ROB */
-void sim_ooo::print_rob(){
-	cout << "REORDER BUFFER" << endl;
-	cout << setfill(' ') << setw(5) << "Entry" << setw(6) << "Busy" << setw(7) << "Ready" << setw(12) << "PC" << setw(10) << "State" << setw(6) << "Dest" << setw(12) << "Value" << endl;
+void sim_ooo::print_rob(ostream &out){
+	out << "REORDER BUFFER" << endl;
+	out << setfill(' ') << setw(5) << "Entry" << setw(6) << "Busy" << setw(7) << "Ready" << setw(12) << "PC" << setw(10) << "State" << setw(6) << "Dest" << setw(12) << "Value" << endl;
 	for(unsigned i=0; i< rob.num_entries;i++){
 		rob_entry_t entry = rob.entries[i];
 		instruction_t instruction;
 		if (entry.pc != UNDEFINED) instruction = instr_memory[(entry.pc-instr_base_address)>>2]; 
-		cout << setfill(' ');
-		cout << setw(5) << i;
-		cout << setw(6);
-		if (entry.pc==UNDEFINED) cout << "no"; else cout << "yes";
-		cout << setw(7);
-		if (entry.ready) cout << "yes"; else cout << "no";	
-		if (entry.pc!= UNDEFINED ) cout << "  0x" << hex << setfill('0') << setw(8) << entry.pc;
-		else	cout << setw(12) << "-";
-		cout << setfill(' ') << setw(10);
-		if (entry.pc==UNDEFINED) cout << "-";		
-		else cout << stage_names[entry.state];
-		if (entry.destination==UNDEFINED) cout << setw(6) << "-";
+		out << setfill(' ');
+		out << setw(5) << i;
+		out << setw(6);
+		if (entry.pc==UNDEFINED) out << "no"; else out << "yes";
+		out << setw(7);
+		if (entry.ready) out << "yes"; else out << "no";	
+		if (entry.pc!= UNDEFINED ) out << "  0x" << hex << setfill('0') << setw(8) << entry.pc;
+		else	out << setw(12) << "-";
+		out << setfill(' ') << setw(10);
+		if (entry.pc==UNDEFINED) out << "-";		
+		else out << stage_names[entry.state];
+		if (entry.destination==UNDEFINED) out << setw(6) << "-";
 		else{
 			if (instruction.opcode == SW || instruction.opcode == SWS)
-				cout << setw(6) << dec << entry.destination; 
+				out << setw(6) << dec << entry.destination; 
 			else if (entry.destination < NUM_GP_REGISTERS)
-				cout << setw(5) << "R" << dec << entry.destination;
+				out << setw(5) << "R" << dec << entry.destination;
 			else
-				cout << setw(5) << "F" << dec << entry.destination-NUM_GP_REGISTERS;
+				out << setw(5) << "F" << dec << entry.destination-NUM_GP_REGISTERS;
 		}
-		if (entry.value!=UNDEFINED) cout << "  0x" << hex << setw(8) << setfill('0') << entry.value << endl;	
-		else cout << setw(12) << setfill(' ') << "-" << endl;
+		if (entry.value!=UNDEFINED) out << "  0x" << hex << setw(8) << setfill('0') << entry.value << endl;	
+		else out << setw(12) << setfill(' ') << "-" << endl;
 	}
-	cout << endl;
+	out << endl;
 }
 
 /* prints the content of the reservation stations */
-void sim_ooo::print_reservation_stations(){
-	cout << "RESERVATION STATIONS" << endl;
-	cout  << setfill(' ');
-	cout << setw(7) << "Name" << setw(6) << "Busy" << setw(12) << "PC" << setw(12) << "Vj" << setw(12) << "Vk" << setw(6) << "Qj" << setw(6) << "Qk" << setw(6) << "Dest" << setw(12) << "Address" << endl; 
+void sim_ooo::print_reservation_stations(ostream &out){
+	out << "RESERVATION STATIONS" << endl;
+	out  << setfill(' ');
+	out << setw(7) << "Name" << setw(6) << "Busy" << setw(12) << "PC" << setw(12) << "Vj" << setw(12) << "Vk" << setw(6) << "Qj" << setw(6) << "Qk" << setw(6) << "Dest" << setw(12) << "Address" << endl; 
 	for(unsigned i=0; i< reservation_stations.num_entries;i++){
 		res_station_entry_t entry = reservation_stations.entries[i];
-	 	cout  << setfill(' ');
-		cout << setw(6); 
-		cout << res_station_names[entry.type];
-		cout << entry.name + 1;
-		cout << setw(6);
-		if (entry.pc==UNDEFINED) cout << "no"; else cout << "yes";
-		if (entry.pc!= UNDEFINED ) cout << setw(4) << "  0x" << hex << setfill('0') << setw(8) << entry.pc;
-		else	cout << setfill(' ') << setw(12) <<  "-";			
-		if (entry.value1!= UNDEFINED ) cout << "  0x" << setfill('0') << setw(8) << hex << entry.value1;
-		else	cout << setfill(' ') << setw(12) << "-";			
-		if (entry.value2!= UNDEFINED ) cout << "  0x" << setfill('0') << setw(8) << hex << entry.value2;
-		else	cout << setfill(' ') << setw(12) << "-";			
-		cout << setfill(' ');
-		cout <<setw(6);
-		if (entry.tag1!= UNDEFINED ) cout << dec << entry.tag1;
-		else	cout << "-";			
-		cout <<setw(6);
-		if (entry.tag2!= UNDEFINED ) cout << dec << entry.tag2;
-		else	cout << "-";			
-		cout <<setw(6);
-		if (entry.destination!= UNDEFINED ) cout << dec << entry.destination;
-		else	cout << "-";			
-		if (entry.address != UNDEFINED ) cout <<setw(4) << "  0x" << setfill('0') << setw(8) << hex << entry.address;
-		else	cout << setfill(' ') << setw(12) <<  "-";			
-		cout << endl;	
-	}
-	cout << endl;
+	 	out  << setfill(' ');
+		out << setw(6); 
+		out << res_station_names[entry.type];
+		out << entry.name + 1;
+		out << setw(6);
+		if (entry.pc==UNDEFINED) out << "no"; else out << "yes";
+		if (entry.pc!= UNDEFINED ) out << setw(4) << "  0x" << hex << setfill('0') << setw(8) << entry.pc;
+		else	out << setfill(' ') << setw(12) <<  "-";			
+		if (entry.value1!= UNDEFINED ) out << "  0x" << setfill('0') << setw(8) << hex << entry.value1;
+		else	out << setfill(' ') << setw(12) << "-";			
+		if (entry.value2!= UNDEFINED ) out << "  0x" << setfill('0') << setw(8) << hex << entry.value2;
+		else	out << setfill(' ') << setw(12) << "-";			
+		out << setfill(' ');
+		out <<setw(6);
+		if (entry.tag1!= UNDEFINED ) out << dec << entry.tag1;
+		else	out << "-";			
+		out <<setw(6);
+		if (entry.tag2!= UNDEFINED ) out << dec << entry.tag2;
+		else	out << "-";			
+		out <<setw(6);
+		if (entry.destination!= UNDEFINED ) out << dec << entry.destination;
+		else	out << "-";			
+		if (entry.address != UNDEFINED ) out <<setw(4) << "  0x" << setfill('0') << setw(8) << hex << entry.address;
+		else	out << setfill(' ') << setw(12) <<  "-";			
+		out << endl;	
+	}
+	out << endl;
 }
 
 /* prints the state of the pending instructions */
-void sim_ooo::print_pending_instructions(){
-	cout << "PENDING INSTRUCTIONS STATUS" << endl;
-	cout << setfill(' ');
-	cout << setw(10) << "PC" << setw(7) << "Issue" << setw(7) << "Exe" << setw(7) << "WR" << setw(7) << "Commit";
-	cout << endl;
+void sim_ooo::print_pending_instructions(ostream &out){
+	out << "PENDING INSTRUCTIONS STATUS" << endl;
+	out << setfill(' ');
+	out << setw(10) << "PC" << setw(7) << "Issue" << setw(7) << "Exe" << setw(7) << "WR" << setw(7) << "Commit";
+	out << endl;
 	for(unsigned i=0; i< pending_instructions.num_entries;i++){
 		instr_window_entry_t entry = pending_instructions.entries[i];
-		if (entry.pc!= UNDEFINED ) cout << "0x" << setfill('0') << setw(8) << hex << entry.pc;
-		else	cout << setfill(' ') << setw(10)  << "-";
-		cout << setfill(' ');
-		cout << setw(7);			
-		if (entry.issue!= UNDEFINED ) cout << dec << entry.issue;
-		else	cout << "-";			
-		cout << setw(7);			
-		if (entry.exe!= UNDEFINED ) cout << dec << entry.exe;
-		else	cout << "-";			
-		cout << setw(7);			
-		if (entry.wr!= UNDEFINED ) cout << dec << entry.wr;
-		else	cout << "-";			
-		cout << setw(7);			
-		if (entry.commit!= UNDEFINED ) cout << dec << entry.commit;
-		else	cout << "-";
-		cout << endl;			
-	}
-	cout << endl;
+		if (entry.pc!= UNDEFINED ) out << "0x" << setfill('0') << setw(8) << hex << entry.pc;
+		else	out << setfill(' ') << setw(10)  << "-";
+		out << setfill(' ');
+		out << setw(7);			
+		if (entry.issue!= UNDEFINED ) out << dec << entry.issue;
+		else	out << "-";			
+		out << setw(7);			
+		if (entry.exe!= UNDEFINED ) out << dec << entry.exe;
+		else	out << "-";			
+		out << setw(7);			
+		if (entry.wr!= UNDEFINED ) out << dec << entry.wr;
+		else	out << "-";			
+		out << setw(7);			
+		if (entry.commit!= UNDEFINED ) out << dec << entry.commit;
+		else	out << "-";
+		out << endl;			
+	}
+	out << endl;
 }
 
 
@@ -420,16 +640,16 @@ void sim_ooo::commit_to_log(instr_window_entry_t entry){
 }
 
 /* prints the content of the log */
-void sim_ooo::print_log(){
-	cout << log.str();
+void sim_ooo::print_log(ostream &out){
+	out << log.str();
 }
 
 /* prints the state of the pending instruction, the content of the ROB, the content of the reservation stations and of the registers */
-void sim_ooo::print_status(){
-	print_pending_instructions();
-	print_rob();
-	print_reservation_stations();
-	print_registers();
+void sim_ooo::print_status(ostream &out){
+	print_pending_instructions(out);
+	print_rob(out);
+	print_reservation_stations(out);
+	print_registers(out);
 }
 
 /* execution statistics */
@@ -440,6 +660,98 @@ unsigned sim_ooo::get_instructions_executed(){return instructions_executed;}
 
 unsigned sim_ooo::get_clock_cycles(){return clock_cycles;}
 
+unsigned sim_ooo::get_rob_stalls(){return rob_full_stalls;}
+
+unsigned sim_ooo::get_rs_stalls(){return rs_full_stalls;}
+
+unsigned sim_ooo::get_forwarded_loads(){return forwarded_loads;}
+
+unsigned sim_ooo::get_disambiguation_stalls(){return disambiguation_stalls;}
+
+unsigned sim_ooo::get_memory_order_violations(){return memory_violations;}
+
+unsigned sim_ooo::get_false_dependences(){return false_dependences;}
+
+unsigned sim_ooo::get_store_commit_stalls(){return store_commit_stalls;}
+
+unsigned sim_ooo::get_combined_stores(){return combined_stores;}
+
+unsigned sim_ooo::get_port_stalls(){return port_stalls;}
+
+unsigned sim_ooo::get_bank_conflicts(){return bank_conflicts;}
+
+double sim_ooo::get_load_port_utilization(){
+	return load_ports == 0 || clock_cycles == 0 ? 0 : (double)load_port_accesses / ((double)load_ports * clock_cycles);
+}
+
+double sim_ooo::get_store_port_utilization(){
+	return load_ports == 0 || clock_cycles == 0 ? 0 : (double)store_port_accesses / ((double)store_ports * clock_cycles);
+}
+
+unsigned sim_ooo::get_cdb_conflicts(){return cdb_conflicts;}
+
+double sim_ooo::get_cdb_utilization(){
+	return num_cdbs == 0 || clock_cycles == 0 ? 0 : (double)cdb_broadcasts / ((double)num_cdbs * clock_cycles);
+}
+
+unsigned sim_ooo::get_branches(){return branches;}
+
+unsigned sim_ooo::get_branch_mispredictions(){return branch_mispredictions;}
+
+double sim_ooo::get_branch_accuracy(){
+	return branches == 0 ? 1 : 1 - (double)branch_mispredictions / branches;
+}
+
+double sim_ooo::get_branch_mpki(){
+	return instructions_executed == 0 ? 0 : 1000.0 * branch_mispredictions / instructions_executed;
+}
+
+unsigned sim_ooo::get_btb_misses(){return btb_misses;}
+
+unsigned sim_ooo::get_early_redirects(){return early_redirects;}
+
+unsigned sim_ooo::get_redirect_stalls(){return redirect_stalls;}
+
+unsigned sim_ooo::get_frontend_stalls(){return frontend_stalls;}
+
+unsigned sim_ooo::get_fetch_bubbles(){return fetch_bubbles;}
+
+void sim_ooo::set_loop_buffer(unsigned entries){
+	loop_buffer_size = entries;
+	loop_branch_pc = UNDEFINED;
+	loop_end = UNDEFINED;
+}
+
+unsigned sim_ooo::get_loop_buffer_fetches(){return loop_buffer_fetches;}
+
+void sim_ooo::set_macro_op_fusion(bool enable){macro_op_fusion = enable;}
+
+unsigned sim_ooo::get_fused_pairs(){return fused_pairs;}
+
+double sim_ooo::get_fusion_rate(){
+	if (instructions_executed == 0) return 0;
+	return 2.0 * fused_pairs / instructions_executed;
+}
+
+double sim_ooo::get_loop_buffer_coverage(){
+	if (fetched_instructions == 0) return 0;
+	return (double)loop_buffer_fetches / fetched_instructions;
+}
+
+unsigned sim_ooo::get_tlb_accesses(){return dtlb.get_accesses();}
+
+unsigned sim_ooo::get_tlb_misses(){return dtlb.get_misses();}
+
+double sim_ooo::get_dram_row_hit_rate(){return dram.get_row_hit_rate();}
+
+double sim_ooo::get_dram_bandwidth(){return dram.get_bandwidth();}
+
+unsigned sim_ooo::get_cache_hits(unsigned level){return dcache.at(level).get_hits();}
+
+unsigned sim_ooo::get_cache_misses(unsigned level){return dcache.at(level).get_misses();}
+
+bool sim_ooo::is_finished(){return finished;}
+
 
 
 /* ============================================================================
@@ -450,10 +762,41 @@ unsigned sim_ooo::get_clock_cycles(){return clock_cycles;}
 
 
 void sim_ooo::load_program(const char *filename, unsigned base_address){
+   /* parsing into a scratch copy, so that a failed load leaves the current program untouched */
+   instruction_t *program = new instruction_t[PROGRAM_SIZE];
+   try{
+	parse_program(filename, program);
+   } catch (const sim_error &e){
+	delete [] program;
+	throw;
+   }
+   load_program(program, base_address);
+   delete [] program;
+}
+
+void sim_ooo::load_program(const instruction_t *program, unsigned base_address){
 
    /* initializing the base instruction address */
    instr_base_address = base_address;
 
+   if (program != instr_memory)
+	for (int i=0; i<PROGRAM_SIZE; i++) instr_memory[i] = program[i];
+
+   pc = instr_base_address;
+}
+
+void parse_program(const char *filename, instruction_t *instr_memory){
+
+   /* clearing the program */
+   for (int i=0; i<PROGRAM_SIZE; i++){
+	instr_memory[i].opcode=(opcode_t)EOP;
+	instr_memory[i].src1=UNDEFINED;
+	instr_memory[i].src2=UNDEFINED;
+	instr_memory[i].dest=UNDEFINED;
+	instr_memory[i].immediate=UNDEFINED;
+	instr_memory[i].label="";
+   }
+
    /* creating a map with the valid opcodes and with the valid labels */
    map<string, opcode_t> opcodes; //for opcodes
    map<string, unsigned> labels;  //for branches
@@ -462,30 +805,33 @@ void sim_ooo::load_program(const char *filename, unsigned base_address){
 
    /* opening the assembly file */
    ifstream fin(filename, ios::in | ios::binary);
-   if (!fin.is_open()) {
-      cerr << "error: open file " << filename << " failed!" << endl;
-      exit(-1);
-   }
+   if (!fin.is_open()) throw sim_error("open file " + string(filename) + " failed!");
 
    /* parsing the assembly file line by line */
    string line;
    unsigned instruction_nr = 0;
+   char *saveptr;     // strtok_r state, so that programs can be parsed concurrently
+   char *reg_saveptr; // strtok_r state used to split a single operand
    while (getline(fin,line)){
 	
 	// set the instruction field
 	char *str = const_cast<char*>(line.c_str());
 
   	// tokenize the instruction
-	char *token = strtok (str," \t");
+	char *token = strtok_r (str," \t\r", &saveptr);
+	if (token == NULL) continue; // empty line
+	if (instruction_nr == PROGRAM_SIZE) throw sim_error("program " + string(filename) + " is too large!");
 	map<string, opcode_t>::iterator search = opcodes.find(token);
         if (search == opcodes.end()){
 		// this is a label for a branch - extract it and save it in the labels map
+		if (token[strlen(token)-1] != ':') throw sim_error("invalid opcode: " + string(token) + " !");
 		string label = string(token).substr(0, string(token).length() - 1);
 		labels[label]=instruction_nr;
 		// move to next token, which must be the instruction opcode
-		token = strtok (NULL, " \t");
+		token = strtok_r (NULL, " \t\r", &saveptr);
+		if (token == NULL) throw sim_error("missing opcode after label " + label + " !");
 		search = opcodes.find(token);
-		if (search == opcodes.end()) cout << "ERROR: invalid opcode: " << token << " !" << endl;
+		if (search == opcodes.end()) throw sim_error("invalid opcode: " + string(token) + " !");
 	}
 
 	instr_memory[instruction_nr].opcode = search->second;
@@ -505,37 +851,37 @@ void sim_ooo::load_program(const char *filename, unsigned base_address){
 		case SUBS:
 		case MULTS:
 		case DIVS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "RF"));
-			instr_memory[instruction_nr].src2 = atoi(strtok(par3, "RF"));
+			par1 = strtok_r(NULL, " \t", &saveptr);
+			par2 = strtok_r(NULL, " \t", &saveptr);
+			par3 = strtok_r(NULL, " \t", &saveptr);
+			instr_memory[instruction_nr].dest = atoi(strtok_r(par1, "RF", &reg_saveptr));
+			instr_memory[instruction_nr].src1 = atoi(strtok_r(par2, "RF", &reg_saveptr));
+			instr_memory[instruction_nr].src2 = atoi(strtok_r(par3, "RF", &reg_saveptr));
 			break;
 		case ADDI:
 		case SUBI:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			par3 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "R"));
-			instr_memory[instruction_nr].src1 = atoi(strtok(par2, "R"));
+			par1 = strtok_r(NULL, " \t", &saveptr);
+			par2 = strtok_r(NULL, " \t", &saveptr);
+			par3 = strtok_r(NULL, " \t", &saveptr);
+			instr_memory[instruction_nr].dest = atoi(strtok_r(par1, "R", &reg_saveptr));
+			instr_memory[instruction_nr].src1 = atoi(strtok_r(par2, "R", &reg_saveptr));
 			instr_memory[instruction_nr].immediate = strtoul (par3, NULL, 0); 
 			break;
 		case LW:
 		case LWS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].dest = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src1 = atoi(strtok(NULL, "R"));
+			par1 = strtok_r(NULL, " \t", &saveptr);
+			par2 = strtok_r(NULL, " \t", &saveptr);
+			instr_memory[instruction_nr].dest = atoi(strtok_r(par1, "RF", &reg_saveptr));
+			instr_memory[instruction_nr].immediate = strtoul(strtok_r(par2, "()", &reg_saveptr), NULL, 0);
+			instr_memory[instruction_nr].src1 = atoi(strtok_r(NULL, "R", &reg_saveptr));
 			break;
 		case SW:
 		case SWS:
-			par1 = strtok (NULL, " \t");
-			par2 = strtok (NULL, " \t");
-			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "RF"));
-			instr_memory[instruction_nr].immediate = strtoul(strtok(par2, "()"), NULL, 0);
-			instr_memory[instruction_nr].src2 = atoi(strtok(NULL, "R"));
+			par1 = strtok_r(NULL, " \t", &saveptr);
+			par2 = strtok_r(NULL, " \t", &saveptr);
+			instr_memory[instruction_nr].src1 = atoi(strtok_r(par1, "RF", &reg_saveptr));
+			instr_memory[instruction_nr].immediate = strtoul(strtok_r(par2, "()", &reg_saveptr), NULL, 0);
+			instr_memory[instruction_nr].src2 = atoi(strtok_r(NULL, "R", &reg_saveptr));
 			break;
 		case BEQZ:
 		case BNEZ:
@@ -543,13 +889,13 @@ void sim_ooo::load_program(const char *filename, unsigned base_address){
 		case BGTZ:
 		case BLEZ:
 		case BGEZ:
-			par1 = strtok (NULL, " \r");
-			par2 = strtok (NULL, " \r");	// changed \t to \r (-:
-			instr_memory[instruction_nr].src1 = atoi(strtok(par1, "R"));
+			par1 = strtok_r(NULL, " \t\r", &saveptr);
+			par2 = strtok_r(NULL, " \t\r", &saveptr);
+			instr_memory[instruction_nr].src1 = atoi(strtok_r(par1, "R", &reg_saveptr));
 			instr_memory[instruction_nr].label = par2;
 			break;
 		case JUMP:
-			par2 = strtok (NULL, " \t");
+			par2 = strtok_r(NULL, " \t\r", &saveptr);
 			instr_memory[instruction_nr].label = par2;
 		default:
 			break;
@@ -573,7 +919,6 @@ void sim_ooo::load_program(const char *filename, unsigned base_address){
 	}
         i++;
    }
-
 }
 
 /* ============================================================================
@@ -588,13 +933,16 @@ sim_ooo::sim_ooo(unsigned mem_size,
                 unsigned num_add_res_stations,
                 unsigned num_mul_res_stations,
                 unsigned num_load_res_stations,
-		unsigned max_issue){
+		unsigned max_issue,
+		unsigned max_commit){
 	//memory
-	data_memory_size = mem_size;
-	data_memory = new unsigned char[data_memory_size];
+	data_memory = new sim_memory(mem_size);
+	owns_data_memory = true;
 
-	//issue width
+	//issue and commit width
 	issue_width = max_issue;
+	commit_width = max_commit == 0 ? 1 : max_commit;
+	issue_group.resize(issue_width);
 
 	//rob, instruction window, reservation stations
 	rob.num_entries=rob_size;
@@ -622,11 +970,170 @@ sim_ooo::sim_ooo(unsigned mem_size,
 	}
 	//execution units
 	num_units = 0;
+	instr_base_address = 0;
+	//functional-first simulation (disabled by default)
+	functional_first = false;
+	oracle_queue_size = 4096;
+	oracle = NULL;
+	reuse = NULL;
+	store_forwarding_latency = 1;
+	store_buffer_size = 0;
+	store_buffer_line = 64;
+	load_ports = 0;
+	store_ports = 0;
+	num_banks = 1;
+	bank_interleave = 8;
+	num_cdbs = 0;
+	cdb_arbitration = OLDEST_FIRST;
+	bpred = NULL;
+	bpred_type = STATIC_NOT_TAKEN;
+	bpred_entries = 0;
+	bpred_history_bits = 0;
+	early_branch_resolution = false;
+	redirect_penalty = 1;
+	fetch_width = 0;
+	loop_buffer_size = 0;
+	macro_op_fusion = false;
+	fetch_queue_size = 16;
+	taken_branch_bubbles = 1;
+	decode_latency = 1;
+	rob_oracle = new dyn_instr_t[rob_size];
+	rob_oracle_branch = new dyn_instr_t[rob_size];
+	rob_oracle_valid = new bool[rob_size];
 	reset();
 }
 	
+sim_ooo::sim_ooo(const sim_ooo &other){
+	if (other.oracle != NULL) throw sim_error("a functional-first simulation cannot be copied once running!");
+
+	issue_width = other.issue_width;
+	commit_width = other.commit_width;
+	issue_group.resize(issue_width);
+
+	pending_instructions.num_entries = other.pending_instructions.num_entries;
+	pending_instructions.entries = new instr_window_entry_t[pending_instructions.num_entries];
+	memcpy(pending_instructions.entries, other.pending_instructions.entries, pending_instructions.num_entries*sizeof(instr_window_entry_t));
+	rob.num_entries = other.rob.num_entries;
+	rob.entries = new rob_entry_t[rob.num_entries];
+	memcpy(rob.entries, other.rob.entries, rob.num_entries*sizeof(rob_entry_t));
+	reservation_stations.num_entries = other.reservation_stations.num_entries;
+	reservation_stations.entries = new res_station_entry_t[reservation_stations.num_entries];
+	memcpy(reservation_stations.entries, other.reservation_stations.entries, reservation_stations.num_entries*sizeof(res_station_entry_t));
+
+	num_units = other.num_units;
+	for (unsigned i=0; i<MAX_UNIT_ENTRIES; i++) exec_units[i] = other.exec_units[i];
+	for (unsigned i=0; i<PROGRAM_SIZE; i++) instr_memory[i] = other.instr_memory[i];
+	instr_base_address = other.instr_base_address;
+
+	data_memory = new sim_memory(*other.data_memory);
+	owns_data_memory = true;
+
+	instructions_executed = other.instructions_executed;
+	clock_cycles = other.clock_cycles;
+	log << other.log.str();
+
+	pc = other.pc;
+	for (unsigned i=0; i<NUM_GP_REGISTERS; i++){
+		int_registers[i] = other.int_registers[i];
+		fp_registers[i] = other.fp_registers[i];
+	}
+	ROB_headptr = other.ROB_headptr;
+	ROB_nextindex = other.ROB_nextindex;
+	memcpy(rename_map, other.rename_map, sizeof rename_map);
+	finished = other.finished;
+	rob_full_stalls = other.rob_full_stalls;
+	rs_full_stalls = other.rs_full_stalls;
+	lsq_index = other.lsq_index;
+	lsq_unresolved = other.lsq_unresolved;
+	store_forwarding_latency = other.store_forwarding_latency;
+	forwarded_loads = other.forwarded_loads;
+	disambiguation_stalls = other.disambiguation_stalls;
+	store_sets = other.store_sets;
+	lsq_load_index = other.lsq_load_index;
+	memory_violations = other.memory_violations;
+	false_dependences = other.false_dependences;
+	store_buffer = other.store_buffer;
+	store_buffer_size = other.store_buffer_size;
+	store_buffer_line = other.store_buffer_line;
+	store_commit_stalls = other.store_commit_stalls;
+	combined_stores = other.combined_stores;
+	load_ports = other.load_ports;
+	store_ports = other.store_ports;
+	num_banks = other.num_banks;
+	bank_interleave = other.bank_interleave;
+	bank_cycle = other.bank_cycle;
+	loads_this_cycle = other.loads_this_cycle;
+	stores_this_cycle = other.stores_this_cycle;
+	load_port_accesses = other.load_port_accesses;
+	store_port_accesses = other.store_port_accesses;
+	port_stalls = other.port_stalls;
+	bank_conflicts = other.bank_conflicts;
+	num_cdbs = other.num_cdbs;
+	cdb_arbitration = other.cdb_arbitration;
+	cdb_broadcasts = other.cdb_broadcasts;
+	cdb_conflicts = other.cdb_conflicts;
+	bpred = other.bpred == NULL ? NULL : other.bpred->clone();
+	bpred_type = other.bpred_type;
+	bpred_entries = other.bpred_entries;
+	bpred_history_bits = other.bpred_history_bits;
+	btb = other.btb;
+	branches = other.branches;
+	branch_mispredictions = other.branch_mispredictions;
+	btb_misses = other.btb_misses;
+	early_branch_resolution = other.early_branch_resolution;
+	redirect_penalty = other.redirect_penalty;
+	redirect_cycle = other.redirect_cycle;
+	early_redirects = other.early_redirects;
+	redirect_stalls = other.redirect_stalls;
+	fetch_queue = other.fetch_queue;
+	fetch_width = other.fetch_width;
+	fetch_queue_size = other.fetch_queue_size;
+	taken_branch_bubbles = other.taken_branch_bubbles;
+	decode_latency = other.decode_latency;
+	fetch_pc = other.fetch_pc;
+	fetch_restart = other.fetch_restart;
+	frontend_stalls = other.frontend_stalls;
+	fetch_bubbles = other.fetch_bubbles;
+	fetched_instructions = other.fetched_instructions;
+	loop_buffer_size = other.loop_buffer_size;
+	loop_branch_pc = other.loop_branch_pc;
+	loop_start = other.loop_start;
+	loop_end = other.loop_end;
+	loop_buffer_fetches = other.loop_buffer_fetches;
+	macro_op_fusion = other.macro_op_fusion;
+	fused_pairs = other.fused_pairs;
+	dispatched_units = other.dispatched_units;
+	dtlb = other.dtlb;
+	dcache = other.dcache;
+	reuse = other.reuse == NULL ? NULL : new sim_reuse(*other.reuse);
+	dram = other.dram;
+	dram_waits = other.dram_waits;
+
+	functional_first = other.functional_first;
+	oracle_queue_size = other.oracle_queue_size;
+	oracle = NULL;
+	oracle_next = other.oracle_next;
+	oracle_has_next = other.oracle_has_next;
+	oracle_replay = other.oracle_replay;
+	on_correct_path = other.on_correct_path;
+	rob_oracle = new dyn_instr_t[rob.num_entries];
+	rob_oracle_branch = new dyn_instr_t[rob.num_entries];
+	rob_oracle_valid = new bool[rob.num_entries];
+	for (unsigned i=0; i<rob.num_entries; i++){
+		rob_oracle[i] = other.rob_oracle[i];
+		rob_oracle_branch[i] = other.rob_oracle_branch[i];
+		rob_oracle_valid[i] = other.rob_oracle_valid[i];
+	}
+}
+
 sim_ooo::~sim_ooo(){
-	delete [] data_memory;
+	delete oracle;
+	delete bpred;
+	delete reuse;
+	delete [] rob_oracle;
+	delete [] rob_oracle_branch;
+	delete [] rob_oracle_valid;
+	if (owns_data_memory) delete data_memory;
 	delete [] rob.entries;
 	delete [] pending_instructions.entries;
 	delete [] reservation_stations.entries;
@@ -638,582 +1145,843 @@ sim_ooo::~sim_ooo(){
 
    ============================================================= */
 
-/* core of the simulator */
-void sim_ooo::run(unsigned cycles){	// cycles = stop target
-	
-	if(finished) return;
-	
-	bool end_of_program = false;
-	int local_cycles = -1; // cycles this function call
-		pc = real_pc * 4 + instr_base_address;
-		bool to_completion = (cycles == 0);
-		bool branched_this_cycle = false;
-	// if cycles == 0, run until EOP (return)
-	// if cycles != 0, run until cycle count 
-	while(local_cycles < (int)cycles - 1 || to_completion){
-		
-		//if(clock_cycles == 120) print_log();
-		if(branched_this_cycle) branched_this_cycle = false;
-		if(finished) return;
-		clock_cycles++;
-		local_cycles++;
-
+/* returns the instruction in ROB entry rob_index */
+instruction_t &sim_ooo::rob_instruction(unsigned rob_index){
+	return instr_memory[(rob.entries[rob_index].pc - instr_base_address) >> 2];
+}
 
+/* reads a source register at issue (from the register file, or from the ROB if its producer already wrote it) */
+void sim_ooo::read_operand(unsigned slot, unsigned producer, unsigned *value, unsigned *tag){
+	*tag = producer;
+	*value = UNDEFINED;
+	if (slot == UNDEFINED){
+		*tag = UNDEFINED;
+	}else if (*tag == UNDEFINED){
+		*value = slot < NUM_GP_REGISTERS ? int_registers[slot] : float2unsigned(fp_registers[slot - NUM_GP_REGISTERS]);
+	}else if (rob.entries[*tag].ready){
+		*value = rob.entries[*tag].value;
+		*tag = UNDEFINED;
+	}
+}
 
-		
+/* load/store queue: a store is indexed under the (one or two) words it writes once its address is known */
+void sim_ooo::lsq_insert(unsigned rob_index){
+	rob.entries[rob_index].store_address = UNDEFINED;
+	lsq_unresolved++;
+	store_sets.store_fetched(rob.entries[rob_index].pc, rob_index);
+}
 
+void sim_ooo::lsq_resolve(unsigned rob_index, unsigned address){
+	rob.entries[rob_index].store_address = address;
+	lsq_unresolved--;
+	lsq_index.insert(make_pair(address >> 2, rob_index));
+	if (((address + 3) >> 2) != (address >> 2)) lsq_index.insert(make_pair((address + 3) >> 2, rob_index));
+	if (store_sets.enabled()){
+		store_sets.store_resolved(rob.entries[rob_index].pc, rob_index);
+		lsq_check_violations(rob_index);
+	}
+}
 
-		// Decrement busy execution units
-		for(int i = 0; i < num_units; i++){
-			if(exec_units[i].busy == 0) exec_units[i].pc = UNDEFINED; // clear last cycle's finished units
-			if(exec_units[i].busy > 0) exec_units[i].busy--;	
-			if(exec_units[i].released_this_cycle) exec_units[i].released_this_cycle = false;
+void sim_ooo::lsq_remove(unsigned rob_index){
+	unsigned address = rob.entries[rob_index].store_address;
+	if (address == UNDEFINED){
+		lsq_unresolved--;
+		store_sets.store_resolved(rob.entries[rob_index].pc, rob_index);
+		return;
+	}
+	unsigned words[2] = {address >> 2, (address + 3) >> 2};
+	for (unsigned k=0; k<2 && (k == 0 || words[1] != words[0]); k++){
+		pair<multimap<unsigned, unsigned>::iterator, multimap<unsigned, unsigned>::iterator> range = lsq_index.equal_range(words[k]);
+		for (multimap<unsigned, unsigned>::iterator it=range.first; it!=range.second; ++it){
+			if (it->second == rob_index){
+				lsq_index.erase(it);
+				break;
+			}
+		}
+	}
+}
 
+/* memory speculation: the executed loads are indexed under the words they read, like the stores */
+void sim_ooo::lsq_execute_load(unsigned rob_index, unsigned address, unsigned source){
+	if (!store_sets.enabled()) return;
+	rob.entries[rob_index].load_address = address;
+	rob.entries[rob_index].load_source = source;
+	lsq_load_index.insert(make_pair(address >> 2, rob_index));
+	if (((address + 3) >> 2) != (address >> 2)) lsq_load_index.insert(make_pair((address + 3) >> 2, rob_index));
+}
 
-			if(exec_units[i].busy == 0 && exec_units[i].pc != UNDEFINED){
-				if(pending_instructions.entries[instr_memory[(exec_units[i].pc - instr_base_address) / 4].pending_index].wr == UNDEFINED) pending_instructions.entries[instr_memory[(exec_units[i].pc - instr_base_address) / 4].pending_index].wr = clock_cycles;// new tc4
+void sim_ooo::lsq_remove_load(unsigned rob_index){
+	unsigned address = rob.entries[rob_index].load_address;
+	if (address == UNDEFINED) return;
+	unsigned words[2] = {address >> 2, (address + 3) >> 2};
+	for (unsigned k=0; k<2 && (k == 0 || words[1] != words[0]); k++){
+		pair<multimap<unsigned, unsigned>::iterator, multimap<unsigned, unsigned>::iterator> range = lsq_load_index.equal_range(words[k]);
+		for (multimap<unsigned, unsigned>::iterator it=range.first; it!=range.second; ++it){
+			if (it->second == rob_index){
+				lsq_load_index.erase(it);
+				break;
 			}
-
 		}
+	}
+	rob.entries[rob_index].load_address = UNDEFINED;
+}
 
-		for(int i = 0; i < reservation_stations.num_entries; i++){
-			reservation_stations.entries[i].received_tag_this_cycle = false;
-			reservation_stations.entries[i].instr_exed_this_cycle = false;
+/* a load younger than the store in ROB entry rob_index, overlapping it, read a stale value unless it took
+   its value from a store between the two (forwarding implies that store wrote all the bytes of the load) */
+void sim_ooo::lsq_check_violations(unsigned rob_index){
+	unsigned n = rob.num_entries;
+	unsigned address = rob.entries[rob_index].store_address;
+	unsigned age = (rob_index + n - ROB_headptr) % n;
+	unsigned load = UNDEFINED;
+	unsigned load_age = 0;
+	unsigned words[2] = {address >> 2, (address + 3) >> 2};
+	for (unsigned k=0; k<2 && (k == 0 || words[1] != words[0]); k++){
+		pair<multimap<unsigned, unsigned>::iterator, multimap<unsigned, unsigned>::iterator> range = lsq_load_index.equal_range(words[k]);
+		for (multimap<unsigned, unsigned>::iterator it=range.first; it!=range.second; ++it){
+			unsigned l = it->second;
+			unsigned l_age = (l + n - ROB_headptr) % n;
+			if (l_age <= age || rob.entries[l].load_address - address + 3 > 6) continue; // older, or no overlap
+			unsigned source = rob.entries[l].load_source;
+			if (source != UNDEFINED){
+				unsigned source_age = (source + n - ROB_headptr) % n;
+				if (source_age > age && source_age < l_age) continue;
+			}
+			if (load == UNDEFINED || l_age < load_age){
+				load = l;
+				load_age = l_age;
+			}
 		}
-		
-
-		// ----------------------------- COMMIT ---------------------------- 
-			// Action at top instruction of ROB (head points at this inst.)
-			rob_entry_t next_entry = rob.entries[ROB_headptr];
-			// If empty (entry.pc == undefined), do nothing. Else:
-			if(!(next_entry.pc == UNDEFINED) && next_entry.ready == true){
-				instructions_executed++;
-			
-				instruction_t entry_instruction = instr_memory[(next_entry.pc - instr_base_address) / 4]; // might need to change this if seg fault from 4/1 pc conversion
-				pending_instructions.entries[entry_instruction.pending_index].commit = clock_cycles;
-			// 	If we are committing last instruction, return at the end of this commit.
-				if(next_entry.pc >= last_instruction_pc) {
-					end_of_program = true;
-				}
-			// 	If ALU/store instruction and result ready:
-				if(next_entry.ready == true && isALUorSTORE(entry_instruction)){
-			// 		store in reg/memory, clean this ROB entry, increment head
-					// use sets (dest = value)
-					clean_rob(&rob.entries[ROB_headptr]);
-					if(is_fp_alu(entry_instruction.opcode)){
-						unsigned dest = next_entry.destination;
-						if(dest >= 32) dest -= 32;
-						set_fp_register(dest,unsigned2float(next_entry.value));
-					}
-					else if(is_int(entry_instruction.opcode)){
-						set_int_register(next_entry.destination,next_entry.value);
-					}
-					//reset_pending_instruction(0);
-				}
-				if(next_entry.ready == true && (entry_instruction.opcode == LWS || entry_instruction.opcode == LW)){
-					int_fp_registers[next_entry.destination] = unsigned2float(next_entry.value);
-					clean_rob(&rob.entries[ROB_headptr]);
-					clean_rob(&rob.entries[entry_instruction.rob_index]);
-					// write here? .out says F1 is written in wr but what do i know
-					//reset_pending_instruction(0);
-				}
-				// ----------------------------------------------------------
-			// 	If branch ( will need adjusting, next pc is computed within branch exe stage)
-			//  so exe unit result holds next pc. compare to what would be pc to determine:
-				// correct prediction (predict branch is not taken):
-				if(next_entry.ready == true && is_branch(entry_instruction.opcode)){
-					unsigned target_pc = alu(entry_instruction.opcode,entry_instruction.src1,entry_instruction.src2,entry_instruction.immediate,pc);
-			// 		clean this ROB entry, increment head
-					if(!next_entry.branch_taken){//if(next_entry.value == 0){ // branch not taken
-						clean_rob(&rob.entries[ROB_headptr]);
-						//reset_pending_instruction(entry_instruction.pending_index);
-					}
-			// 	If branch with incorrect prediction / misprediction:
-					else{ //if(next_entry.value == 1){ // branch taken
-			// 		Clear entire ROB (and execution units?), set PC to correct target address.
-						commit_to_log(pending_instructions.entries[entry_instruction.pending_index]);
-						int dummy_index = next_entry.pc + 4;
-						
-						for(int i = 0; i < pending_instructions.num_entries; i++){
-							for(int j = 0; j < pending_instructions.num_entries; j++){
-								// if this instruction is equal to the committed +4, commit and add another 4
-								if(pending_instructions.entries[j].pc == dummy_index) {
-									if(instr_memory[10].opcode == ADDS && pending_instructions.entries[j].exe == UNDEFINED) pending_instructions.entries[j].exe = clock_cycles;
-									commit_to_log(pending_instructions.entries[j]);
-									reset_pending_instruction(j);
-									dummy_index = dummy_index + 4;
-								}
-							}
-						}
-						
-						for(int i = 0; i < 10; i++){
-							exec_units[i].busy = 0;
-							exec_units[i].pc = UNDEFINED;
-							exec_units[i].released_this_cycle = false;
-							exec_units[i].result = UNDEFINED;
-						}
-						for(int i = 0; i < rob.num_entries; i++) clean_rob(&rob.entries[i]);
-						for(int i = 0; i < pending_instructions.num_entries; i++) reset_pending_instruction(i);
-						for(int i = 0; i < reservation_stations.num_entries; i++) reset_reservation_station(i);
-						//real_pc = rob.entries[ROB_headptr].value;
-						//pc = real_pc * 4 + instr_base_address;
-						pc = next_entry.value;
-						branched_this_cycle = true;
-						real_pc = (pc - instr_base_address) / 4;
-						ROB_headptr = -1;
-						PI_headptr = 0;
-						ROB_nextindex = 0;
-					}
-				}
-				// ----------------------------------------------------------
-			//	Increment head pointer. If pointer == rob size, wrap back to zero. clear pending instruction
-				ROB_headptr++;
-				if(ROB_headptr == rob.num_entries) ROB_headptr = 0;
-				// COMMIT AND CLEAR PENDING INSTRUCTION
-				if(!branched_this_cycle)commit_to_log(pending_instructions.entries[entry_instruction.pending_index]);
-				reset_pending_instruction(entry_instruction.pending_index);
-				pending_instructions.entries[entry_instruction.pending_index].released_this_cycle = true;
+	}
+	if (load == UNDEFINED) return;
+	rob.entries[load].load_violated = true;
+	store_sets.violation(rob.entries[load].pc, rob.entries[rob_index].pc);
+}
 
+/* checks the stores older than the load in ROB entry rob_index, which reads "address"
+   returns false if the load has to wait: the address of an older store is not known yet, or the
+   youngest older store overlapping the load has not written its value, or only partially overlaps it
+   (then the load waits until the store writes the memory); otherwise *store is set to that store
+   (the value is forwarded from its ROB entry), or to UNDEFINED if the load reads the memory */
+bool sim_ooo::load_disambiguate(unsigned rob_index, unsigned address, unsigned *store){
+	*store = UNDEFINED;
+	unsigned n = rob.num_entries;
+	unsigned age = (rob_index + n - ROB_headptr) % n;
+	if (store_sets.enabled()){
+		// memory speculation: only wait for the store the predictor expects to conflict with
+		rob_entry_t &load = rob.entries[rob_index];
+		unsigned d = load.load_dependence;
+		if (d != UNDEFINED){
+			opcode_t opcode = rob.entries[d].pc != UNDEFINED ? rob_instruction(d).opcode : NOP;
+			bool in_flight = (opcode == SW || opcode == SWS) && (d + n - ROB_headptr) % n < age;
+			if (in_flight && rob.entries[d].store_address == UNDEFINED){
+				load.load_held = true;
+				disambiguation_stalls++;
+				return false;
 			}
-
-			if(end_of_program) {
-				finished = true;
-				clock_cycles++;
-				return;
+			if (in_flight && load.load_held && rob.entries[d].store_address - address + 3 > 6) false_dependences++;
+			load.load_dependence = UNDEFINED;
+		}
+	}else if (lsq_unresolved > 0){
+		for (unsigned r=ROB_headptr; r!=rob_index; r=(r+1)%n){
+			opcode_t opcode = rob_instruction(r).opcode;
+			if ((opcode == SW || opcode == SWS) && rob.entries[r].store_address == UNDEFINED){
+				disambiguation_stalls++;
+				return false;
 			}
+		}
+	}
+	// youngest older store overlapping [address, address+4), among the stores indexed under the same words
+	unsigned youngest_age = 0;
+	unsigned words[2] = {address >> 2, (address + 3) >> 2};
+	for (unsigned k=0; k<2 && (k == 0 || words[1] != words[0]); k++){
+		pair<multimap<unsigned, unsigned>::iterator, multimap<unsigned, unsigned>::iterator> range = lsq_index.equal_range(words[k]);
+		for (multimap<unsigned, unsigned>::iterator it=range.first; it!=range.second; ++it){
+			unsigned s = it->second;
+			unsigned s_age = (s + n - ROB_headptr) % n;
+			if (s_age >= age || rob.entries[s].store_address - address + 3 > 6) continue; // younger, or no overlap
+			if (*store == UNDEFINED || s_age > youngest_age){
+				*store = s;
+				youngest_age = s_age;
+			}
+		}
+	}
+	if (*store == UNDEFINED) return true;
+	if (rob.entries[*store].store_address != address || !rob.entries[*store].ready){
+		*store = UNDEFINED;
+		disambiguation_stalls++;
+		return false;
+	}
+	return true;
+}
 
-		// --------------------------- END COMMIT -------------------------- 
-
-	//	unsigned wait_to_write = UNDEFINED;
-
-		// ------------------------------- WR ------------------------------ 
-			// For each unit:
-			for(int i = 0; i < num_units; i++){
-				if(exec_units[i].busy == 0 && exec_units[i].pc != UNDEFINED){
-			//  if instruction is done:
-			// 		write result to ROB. mark ready & write WR cycle in PI	
-					//if(exec_units[i].type == MEMORY || exec_units[i].type == ADDER) {
-						exec_units[i].released_this_cycle = true;
-					//}
-					for(int j = 0; j < rob.num_entries; j++){
-						if(rob.entries[j].pc == exec_units[i].pc && rob.entries[j].pc != UNDEFINED){
-							rob.entries[j].value = exec_units[i].result;
-							rob.entries[j].ready = true;
-							rob.entries[j].state = WRITE_RESULT;
-							if(pending_instructions.entries[instr_memory[(rob.entries[j].pc - instr_base_address) / 4].pending_index].wr == UNDEFINED) pending_instructions.entries[instr_memory[(rob.entries[j].pc - instr_base_address) / 4].pending_index].wr = clock_cycles;	// 4/1 offset
-							// which entry in pending instructions?
-							// instr_memory[rob.entries[i].pc].pending_index
-							// rob.entries[i].pc pointer to instruction in memory'
-							// pending_index stored to instr_memory 
-
-							// clear res station if its pc matches rob entry's pc
-							for(int k = 0; k < reservation_stations.num_entries; k++){
-								if(reservation_stations.entries[k].pc == rob.entries[j].pc) {
-									clean_res_station(&reservation_stations.entries[k]);
-									reservation_stations.entries[k].instr_exed_this_cycle = true; // testing
-								}
-							}
-						}
-					}
-				}
+/* EXE: the instructions whose operands are available start executing, oldest first, if they find a free unit
+   (stores only compute their address, loads forwarded by an older store do not use the memory unit) */
+void sim_ooo::execute(){
+	for (unsigned i=0, r=ROB_headptr; i<rob.num_entries && rob.entries[r].pc!=UNDEFINED; i++, r=(r+1)%rob.num_entries){
+		unsigned s;
+		for (s=0; s<reservation_stations.num_entries; s++)
+			if (reservation_stations.entries[s].pc != UNDEFINED && reservation_stations.entries[s].destination == r) break;
+		if (s == reservation_stations.num_entries) continue;
+		res_station_entry_t &entry = reservation_stations.entries[s];
+		if (entry.wr_cycle != UNDEFINED || entry.tag1 != UNDEFINED || entry.tag2 != UNDEFINED) continue;
+		instruction_t &instr = rob_instruction(r);
+		// functional-first: values, addresses and branch outcomes come from the functional model
+		dyn_instr_t *d = oracle_instr(r);
+		unsigned unit = UNDEFINED;
+		unsigned latency = 1;
+		bool unit_bound = true;
+		if (instr.opcode == SW || instr.opcode == SWS){
+			entry.address = d != NULL ? d->address : entry.value2 + instr.immediate;
+			entry.result = d != NULL ? d->result : entry.value1;
+			rob.entries[r].destination = entry.address;
+		}else if (instr.opcode == LW || instr.opcode == LWS){
+			unsigned address = d != NULL ? d->address : entry.value1 + instr.immediate;
+			unsigned store;
+			if (!load_disambiguate(r, address, &store)) continue;
+			store_buffer_lookup_t buffered = store == UNDEFINED && !store_buffer.empty() ? store_buffer_lookup(address) : SB_MISS;
+			if (buffered == SB_PARTIAL){
+				disambiguation_stalls++;
+				continue;
 			}
-		// ----------------------------- END WR ---------------------------- 
-
-		
-		// ------------------------------ EXE ------------------------------ 
-			// might exe twice? might need to check pending_instructions.entries[instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4].pending_index].exe
-			
-			
-			// For each RS:
-			for(int j = 0; j < reservation_stations.num_entries; j++){
-				bool got = false;
-				instruction_t entry_instruction;
-				entry_instruction = null_inst;
-			//  If station is waiting on operands, monitor for broadcast. otherwise,
-				if(!reservation_stations.entries[j].instr_has_been_exed && reservation_stations.entries[j].pc != UNDEFINED && reservation_stations.entries[j].received_tag_this_cycle == false) entry_instruction = instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4]; // 4/1
-				if((
-			
-						// load rs: needs Vj
-						(entry_instruction.opcode == LWS || entry_instruction.opcode == LW) && (
-							reservation_stations.entries[j].value1 != UNDEFINED || ((clock_cycles == 3 && issue_width == 1))
-						)
-						// int/fp alu rs: needs Vj Vk
-						|| (is_fp_alu(entry_instruction.opcode) || is_int(entry_instruction.opcode)) && (
-							reservation_stations.entries[j].value1 != UNDEFINED && reservation_stations.entries[j].value2 != UNDEFINED
-						) 
-						|| (is_branch(entry_instruction.opcode) && reservation_stations.entries[j].value1 != UNDEFINED)
-						|| (entry_instruction.opcode == XOR)
-						|| (is_int_imm(entry_instruction.opcode) && reservation_stations.entries[j].value1 != UNDEFINED)
-					)
-					//&& reservation_stations.entries[j].tag1 != UNDEFINED && reservation_stations.entries[j].tag2 != UNDEFINED 
-					&& reservation_stations.entries[j].pc != UNDEFINED
-				){
-			//		if unit is available and has operands,
-					
-					unsigned unit_num = get_free_unit(entry_instruction.opcode);
-					if((unit_num != UNDEFINED && exec_units[unit_num].released_this_cycle == false)){
-						// send to unit, mark as busy, compute result
-						got = true;
-						reservation_stations.entries[j].instr_exed_this_cycle = true;	// update rs so a new instruction doesnt enter same cycle
-						exec_units[unit_num].busy = exec_units[get_free_unit(entry_instruction.opcode)].latency;
-						exec_units[unit_num].pc = reservation_stations.entries[j].pc;
-						
-						if(is_fp_alu(entry_instruction.opcode) || is_int(entry_instruction.opcode) || is_branch(entry_instruction.opcode)) {
-							exec_units[unit_num].result = alu(entry_instruction.opcode, reservation_stations.entries[j].value1, reservation_stations.entries[j].value2, entry_instruction.immediate, reservation_stations.entries[j].pc);
-							if(exec_units[unit_num].result == pc+entry_instruction.immediate || exec_units[unit_num].result+4 == pc+entry_instruction.immediate){//if(exec_units[unit_num].result == pc+entry_instruction.immediate || (issue_width == 4 && exec_units[unit_num].result+4 == pc+entry_instruction.immediate)){ // branch taken
-								rob.entries[instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4].rob_index].branch_taken = true;
-							}
-						}
-						if(is_int_imm(entry_instruction.opcode)){
-							exec_units[unit_num].result = alu(entry_instruction.opcode, reservation_stations.entries[j].value1, entry_instruction.immediate, entry_instruction.immediate, reservation_stations.entries[j].pc);
-						}
-						if(
-							exec_units[unit_num].type==MEMORY && (
-								entry_instruction.opcode == LWS || 
-								entry_instruction.opcode == LW
-								)){
-									unsigned base_byte_index = entry_instruction.immediate + get_int_register(entry_instruction.src1);
-									unsigned lmd = UNDEFINED;
-									
-									lmd = data_memory[base_byte_index] + (data_memory[base_byte_index + 1] << 8) + (data_memory[base_byte_index + 2] << 16) + (data_memory[base_byte_index + 3] << 24);
-									exec_units[unit_num].result = lmd;
-									reservation_stations.entries[j].address = base_byte_index;
-									
-								}
-						if(pending_instructions.entries[instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4].pending_index].exe == UNDEFINED){
-							pending_instructions.entries[instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4].pending_index].exe = clock_cycles;
-						}
-						//if(is_branch(entry_instruction.opcode)) 
-						// set state to exe in rob
-						rob.entries[instr_memory[(reservation_stations.entries[j].pc - instr_base_address) / 4].rob_index].state = EXECUTE;
-					}
-				}
-				if(got) reservation_stations.entries[j].instr_has_been_exed = true;
+			if ((store != UNDEFINED || buffered == SB_HIT) && !memory_port_reserve(false, UNDEFINED)) continue;
+			if (store != UNDEFINED){
+				entry.value2 = entry.result = rob.entries[store].value;
+				latency = store_forwarding_latency;
+				forwarded_loads++;
+			}else if (buffered == SB_HIT){
+				// the stores in the buffer already updated the memory
+				entry.result = d != NULL ? d->result : data_memory->read_word(address);
+				latency = store_forwarding_latency;
+				forwarded_loads++;
+			}else{
+				unit = get_free_unit(instr.opcode);
+				if (unit == UNDEFINED || !memory_port_reserve(false, address)) continue;
+				latency = memory_access_latency(unit, address, false, &unit_bound);
+				entry.result = d != NULL ? d->result : data_memory->read_word(address);
 			}
-		// ---------------------------- END EXE ---------------------------- 
-
-
-		// CDB broadcast (moved from after WR to after EXE)
-
-		// 		Broadcast result to all reservation stations in case they
-		// 		were waiting on tag from this execution unit. 
-		// 			(search all RS for a matching tag, update if tag matches the unit's instruction's entry on the rob's index)
-			
-
-		for(int i = 0; i < num_units; i++){
-			if(exec_units[i].busy == 0){
-				for(int j = 0; j < rob.num_entries; j++){
-					for(int k = 0; k < reservation_stations.num_entries; k++){
-						if(reservation_stations.entries[k].tag1 == instr_memory[(exec_units[i].pc - instr_base_address) / 4].rob_index){
-							reservation_stations.entries[k].value1 = exec_units[i].result;
-							reservation_stations.entries[k].tag1 = UNDEFINED;
-							reservation_stations.entries[k].received_tag_this_cycle = true;
-						}
-						if(reservation_stations.entries[k].tag2 == instr_memory[(exec_units[i].pc - instr_base_address) / 4].rob_index){
-							reservation_stations.entries[k].value2 = exec_units[i].result;
-							reservation_stations.entries[k].tag2 = UNDEFINED;
-							reservation_stations.entries[k].received_tag_this_cycle = true;
-						}
-					}
-				}
+			entry.address = address;
+			lsq_execute_load(r, address, store);
+		}else{
+			unit = get_free_unit(instr.opcode);
+			if (unit == UNDEFINED) continue;
+			latency = exec_units[unit].latency;
+			if (d != NULL) entry.result = d->result;
+			else entry.result = alu(instr.opcode, entry.value1, is_int_imm(instr.opcode) ? instr.immediate : entry.value2, instr.immediate, entry.pc);
+			if (is_branch(instr.opcode)){
+				rob.entries[r].branch_taken = d != NULL ? d->taken : (entry.result != entry.pc + 4);
+				rob.entries[r].mispredicted = entry.result != rob.entries[r].predicted_pc;
+			}else if (rob.entries[r].fused){
+				// the fused branch tests the result in the same unit
+				instruction_t &branch = fused_branch(r);
+				rob_entry_t &fused = rob.entries[r];
+				fused.branch_target = d != NULL ? rob_oracle_branch[r].result : alu(branch.opcode, entry.result, 0, branch.immediate, entry.pc + 4);
+				fused.branch_taken = fused.branch_target != entry.pc + 8;
+				fused.mispredicted = fused.branch_target != fused.predicted_pc;
 			}
 		}
+		if (unit != UNDEFINED) occupy_unit(unit, r, latency, unit_bound);
+		entry.wr_cycle = clock_cycles + latency;
+		rob.entries[r].state = EXECUTE;
+		pending_instructions.entries[r].exe = clock_cycles;
+	}
+}
 
-		
-
-
-
-		// ----------------------------- ISSUE ----------------------------- 
-		if(!branched_this_cycle){
-
-
-		// issue width handling - loop through issue (width) times
-		for(int issue_num = 0; issue_num < issue_width; issue_num++){
-
-		if(pending_instructions.entries[PI_headptr].issue != UNDEFINED || pending_instructions.entries[PI_headptr].released_this_cycle == true) break; // if no room, stop
-
-			//if(pending_instructions.entries[PI_headptr].released_this_cycle == false){
-
-			// get instruction at pc
-			IReg = instr_memory[real_pc];
-
-			// eop check
-			if(IReg.opcode == EOP) {
- 				last_instruction_pc = pc - 4;
+/* WR: the instructions that finished executing write their result to the ROB and to the reservation
+   stations waiting for it, and free their reservation station (the unit is freed at the end of the cycle) */
+void sim_ooo::write_result(){
+	if (num_cdbs != 0) cdb_arbitrate();
+	for (unsigned s=0; s<reservation_stations.num_entries; s++){
+		res_station_entry_t &entry = reservation_stations.entries[s];
+		if (entry.pc == UNDEFINED || entry.wr_cycle != clock_cycles) continue;
+		unsigned r = entry.destination;
+		rob.entries[r].value = entry.result;
+		rob.entries[r].ready = true;
+		rob.entries[r].state = WRITE_RESULT;
+		pending_instructions.entries[r].wr = clock_cycles;
+		for (unsigned t=0; t<reservation_stations.num_entries; t++){
+			res_station_entry_t &waiting = reservation_stations.entries[t];
+			if (waiting.pc == UNDEFINED) continue;
+			if (waiting.tag1 == r){
+				waiting.value1 = entry.result;
+				waiting.tag1 = UNDEFINED;
 			}
-
-			// check for structural hazards(free RS/load-store buffer)
-			unsigned found_rs = UNDEFINED;
-			// search reservation stations by type in ireg - matching type and empty
-			if(is_memory(IReg.opcode)){
-				bool tag1 = false;
-				bool tag2 = false;
-				for(unsigned i = 0; i < reservation_stations.num_entries; i++){
-					//if(){
-					if(reservation_stations.entries[i].instr_exed_this_cycle == false && reservation_stations.entries[i].type == LOAD_B && reservation_stations.entries[i].pc == UNDEFINED){
-						found_rs = i;
-						reservation_stations.entries[i].address = IReg.immediate;
-						reservation_stations.entries[found_rs].destination = ROB_nextindex;//IReg.dest; // entry in rob
-						reservation_stations.entries[found_rs].pc = pc;
-						//reservation_stations.entries[found_rs].value1 = IReg.immediate;
-						//reservation_stations.entries[found_rs].value2 = IReg.src2;
-						break;
-					}
-				}
-
-				for(int tag_id = 0; tag_id < reservation_stations.num_entries; tag_id++){
-					if(tag_id != found_rs && instr_memory[(reservation_stations.entries[tag_id].pc - instr_base_address) / 4].dest == IReg.src1){ // base this off of RS not exe unit
-						reservation_stations.entries[found_rs].tag1 = instr_memory[(reservation_stations.entries[tag_id].pc - instr_base_address) / 4].rob_index;
-						tag1 = true;
-					}
-					if(instr_memory[(reservation_stations.entries[tag_id].pc - instr_base_address) / 4].dest == IReg.src2){
-						reservation_stations.entries[found_rs].tag2 = instr_memory[(reservation_stations.entries[tag_id].pc - instr_base_address) / 4].rob_index;
-						tag2 = true;
-					}
-				}
-
-				if(!tag1 && clock_cycles != 2) reservation_stations.entries[found_rs].value1 = IReg.immediate;
-				if(IReg.opcode == LWS && !tag1 && (clock_cycles == 9 || clock_cycles == 0) && issue_width != 4) reservation_stations.entries[found_rs].value1 += get_int_register(IReg.src1);	// NEW TO TC4CC9!
-				if(!tag2) reservation_stations.entries[found_rs].value2 = IReg.src2;
+			if (waiting.tag2 == r){
+				waiting.value2 = entry.result;
+				waiting.tag2 = UNDEFINED;
+				// the base register of a store: its address is known from now on
+				instruction_t &instr = rob_instruction(waiting.destination);
+				if (instr.opcode == SW || instr.opcode == SWS) lsq_resolve(waiting.destination, entry.result + instr.immediate);
 			}
+		}
+		reset_reservation_station(s);
+		entry.released = clock_cycles;
+		if (early_branch_resolution && rob.entries[r].mispredicted) redirect_branch(r);
+	}
+}
 
+/* common data buses: the results due in this clock cycle are sorted by priority (ROB age, or index of the unit);
+   the ones past num_cdbs are held for a clock cycle, and so is the unit that produced them */
+void sim_ooo::cdb_arbitrate(){
+	cdb_requests.clear();
+	for (unsigned s=0; s<reservation_stations.num_entries; s++){
+		res_station_entry_t &entry = reservation_stations.entries[s];
+		if (entry.pc == UNDEFINED || entry.wr_cycle != clock_cycles) continue;
+		unsigned r = entry.destination;
+		opcode_t opcode = rob_instruction(r).opcode;
+		if (opcode == SW || opcode == SWS) continue;
+		unsigned priority = (r + rob.num_entries - ROB_headptr) % rob.num_entries;
+		if (cdb_arbitration == UNIT_ORDER){
+			unsigned u;
+			for (u=0; u<num_units && exec_units[u].rob_index!=r; u++);
+			priority += u * rob.num_entries;
+		}
+		cdb_requests.push_back(make_pair(priority, s));
+	}
+	if (cdb_requests.size() <= num_cdbs){
+		cdb_broadcasts += cdb_requests.size();
+		return;
+	}
+	sort(cdb_requests.begin(), cdb_requests.end());
+	cdb_broadcasts += num_cdbs;
+	for (unsigned i=num_cdbs; i<cdb_requests.size(); i++){
+		res_station_entry_t &entry = reservation_stations.entries[cdb_requests[i].second];
+		entry.wr_cycle++;
+		for (unsigned u=0; u<num_units; u++)
+			if (exec_units[u].rob_index == entry.destination) exec_units[u].busy++;
+		cdb_conflicts++;
+	}
+}
 
+/* early branch resolution: the younger instructions (all on the wrong path) leave the pipeline now, and the
+   speculative history is rebuilt from the one the branch was predicted with, plus its outcome */
+void sim_ooo::redirect_branch(unsigned rob_index){
+	rob_entry_t &entry = rob.entries[rob_index];
+	squash_younger(rob_index);
+	entry.redirected = true;
+	pc = entry.fused ? entry.branch_target : entry.value;
+	flush_front_end();
+	redirect_cycle = clock_cycles + redirect_penalty;
+	if (bpred != NULL){
+		if (rob_instruction(rob_index).opcode == JUMP) bpred->recover(entry.branch_history);
+		else bpred->recover((entry.branch_history << 1) | (entry.branch_taken ? 1 : 0));
+	}
+	// the functional model is on the target path: resume binding its instructions
+	on_correct_path = true;
+}
 
-			if(is_int(IReg.opcode)){
-				bool tag1 = false;
-				bool tag2 = false;
-				for(unsigned i = 0; i < reservation_stations.num_entries; i++){
-					if(reservation_stations.entries[i].instr_exed_this_cycle == false && reservation_stations.entries[i].type == INTEGER_RS && reservation_stations.entries[i].pc == UNDEFINED){
-						found_rs = i;
-						reservation_stations.entries[found_rs].destination = ROB_nextindex;//IReg.dest; // entry in rob
-						reservation_stations.entries[found_rs].pc = pc;
-						
-						/*if(IReg.opcode == XOR){
-							reservation_stations.entries[found_rs].value1 = UNDEFINED;
-							reservation_stations.entries[found_rs].value2 = UNDEFINED;
-						}*/
-						break;
-					}
-				}
-				if(get_int_register_tag(IReg.src1) != UNDEFINED) tag1 = true;
-				if(!tag1) {
-					reservation_stations.entries[found_rs].value1 = (get_int_register(IReg.src1));
-				} else{
-					reservation_stations.entries[found_rs].tag1 = get_int_register_tag(IReg.src1);
-				}
-
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination - 32 == IReg.src1 && rob.entries[rob_index].ready == true) {
-							if(reservation_stations.entries[found_rs].value1 == UNDEFINED){
-								reservation_stations.entries[found_rs].value1 = rob.entries[rob_index].value; //tc5cc8
-								reservation_stations.entries[found_rs].tag1 = UNDEFINED; 	// erase tag
-							}
-						}
-				}
-				if(get_int_register_tag(IReg.src2) != UNDEFINED) tag2 = true;
-				if(!tag2) {
-					reservation_stations.entries[found_rs].value2 = (get_int_register(IReg.src2));
-					if(is_int_imm(IReg.opcode)) reservation_stations.entries[found_rs].value2 = UNDEFINED;
-				} else{
-					reservation_stations.entries[found_rs].tag2 = get_int_register_tag(IReg.src2);
-				}
-
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-					if(rob.entries[rob_index].destination - 32 == IReg.src2 && rob.entries[rob_index].ready == true) {
-						reservation_stations.entries[found_rs].value2 = rob.entries[rob_index].value;
-						reservation_stations.entries[found_rs].tag2 = UNDEFINED; 	// erase tag
-					}
+/* ISSUE: up to issue_width instructions, in program order, each into a free ROB entry and a free
+   reservation station of its type (a station freed in this clock cycle can be used from the next one)
+   the group is decoded first; its sources are renamed in one pass (the rename map as it was before the group,
+   overridden by the comparators with the older instructions of the group), then its entries are allocated */
+void sim_ooo::issue(){
+	if (clock_cycles < redirect_cycle){
+		redirect_stalls++;
+		return;
+	}
+	unsigned n = decode_group();
+	if (n == 0) return;
+
+	// rename: each source compares its slot with the destinations of the older instructions of the group
+	for (unsigned i=0; i<n; i++){
+		issue_slot_t &slot = issue_group[i];
+		for (unsigned k=0; k<2; k++){
+			if (slot.sources[k] == UNDEFINED) continue;
+			slot.producers[k] = rename_lookup(slot.sources[k]);
+			for (unsigned j=i; j-- > 0; ){
+				if (issue_group[j].destination == slot.sources[k]){
+					slot.producers[k] = (ROB_nextindex + j) % rob.num_entries;
+					break;
 				}
 			}
-			
-			if(IReg.opcode == ADDS || IReg.opcode == SUBS){
-				bool tag1 = false;
-				bool tag2 = false;
-				for(unsigned i = 0; i < reservation_stations.num_entries; i++){
-					if(reservation_stations.entries[i].instr_exed_this_cycle == false && reservation_stations.entries[i].type == ADD_RS && reservation_stations.entries[i].pc == UNDEFINED){
-						found_rs = i;
-						reservation_stations.entries[found_rs].destination = ROB_nextindex;//IReg.dest; // entry in rob
-						reservation_stations.entries[found_rs].pc = pc;
-						//reservation_stations.entries[found_rs].value1 = IReg.src1;
-						//reservation_stations.entries[found_rs].value2 = IReg.src2;
-						break;
-					}
-				}
-
-				if(get_fp_register_tag(IReg.src1) != UNDEFINED) tag1 = true;
-				if(!tag1) {
-					reservation_stations.entries[found_rs].value1 = float2unsigned(get_fp_register(IReg.src1));
-				} else{
-					reservation_stations.entries[found_rs].tag1 = get_fp_register_tag(IReg.src1);
-				}
-
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination - 32 == IReg.src1 && rob.entries[rob_index].ready == true) {
-							reservation_stations.entries[found_rs].value1 = rob.entries[rob_index].value;
-							reservation_stations.entries[found_rs].tag1 = UNDEFINED; 	// erase tag
-						}
-				}
-
-
-				if(get_fp_register_tag(IReg.src2) != UNDEFINED) tag2 = true;
-				if(!tag2) {
-					reservation_stations.entries[found_rs].value2 = float2unsigned(get_fp_register(IReg.src2));
-				} else{
-					reservation_stations.entries[found_rs].tag2 = get_fp_register_tag(IReg.src2);
-				}
+		}
+	}
 
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination - 32 == IReg.src2 && rob.entries[rob_index].ready == true) {
-							reservation_stations.entries[found_rs].value2 = rob.entries[rob_index].value;
-							reservation_stations.entries[found_rs].tag2 = UNDEFINED; 	// erase tag
-						}
-				}
+	// allocation: consecutive ROB entries (and instruction window entries), the reservation stations found by decode
+	for (unsigned i=0; i<n; i++){
+		issue_slot_t &slot = issue_group[i];
+		instruction_t &instr = instr_memory[(slot.pc - instr_base_address) >> 2];
+		unsigned r = (ROB_nextindex + i) % rob.num_entries;
+		res_station_entry_t &entry = reservation_stations.entries[slot.station];
+		entry.pc = slot.pc;
+		entry.destination = r;
+		read_operand(slot.sources[0], slot.producers[0], &entry.value1, &entry.tag1);
+		read_operand(slot.sources[1], slot.producers[1], &entry.value2, &entry.tag2);
+		if (is_memory(instr.opcode)) entry.address = instr.immediate;
+		if (instr.opcode == LW || instr.opcode == LWS) rob.entries[r].load_dependence = store_sets.load_fetched(slot.pc);
+
+		rob.entries[r].pc = slot.pc;
+		rob.entries[r].ready = false;
+		rob.entries[r].state = ISSUE;
+		rob.entries[r].destination = slot.destination;
+		if (instr.opcode == SW || instr.opcode == SWS){
+			lsq_insert(r);
+			if (entry.tag2 == UNDEFINED) lsq_resolve(r, entry.value2 + instr.immediate);
+		}
+		pending_instructions.entries[r].pc = slot.pc;
+		pending_instructions.entries[r].issue = clock_cycles;
+		rob.entries[r].fused = slot.fused;
+		rob.entries[r].branch_history = slot.history;
+		rob.entries[r].predicted_pc = slot.next_pc;
+		bind_oracle(r);
+		if (slot.destination != UNDEFINED) rename_map[slot.destination] = r;
+	}
+	ROB_nextindex = (ROB_nextindex + n) % rob.num_entries;
+}
 
-				
+/* decode: the group ends at EOP, at the first instruction without a free ROB entry or reservation station (or,
+   with a front end, not decoded yet), and without a front end after a taken prediction; the next pc of each
+   instruction is predicted here, and the issue continues from the last one */
+unsigned sim_ooo::decode_group(){
+	unsigned next_station[NUM_RS_TYPES] = {0, 0, 0, 0};	// the reservation stations are searched once per group
+	unsigned queued = 0;					// fetch queue entries taken by the group
+	unsigned n;
+	for (n=0; n<issue_width; n++){
+		// with a front end, the issue takes the decoded instructions from the fetch queue
+		if (fetch_width != 0){
+			if (queued == fetch_queue.size() || fetch_queue[queued].ready > clock_cycles){
+				if (n == 0) frontend_stalls++;
+				break;
 			}
+			pc = fetch_queue[queued].pc;
+		}
+		instruction_t &instr = instr_memory[(pc - instr_base_address) >> 2];
+		if (instr.opcode == EOP) break;
+		if (rob.entries[(ROB_nextindex + n) % rob.num_entries].pc != UNDEFINED){
+			rob_full_stalls++;
+			break;
+		}
+		res_station_t type = res_station_type(instr.opcode);
+		unsigned s;
+		for (s=next_station[type]; s<reservation_stations.num_entries; s++){
+			res_station_entry_t &entry = reservation_stations.entries[s];
+			if (entry.type == type && entry.pc == UNDEFINED && entry.released != clock_cycles) break;
+		}
+		if (s == reservation_stations.num_entries){
+			rs_full_stalls++;
+			break;
+		}
+		next_station[type] = s + 1;
+
+		issue_slot_t &slot = issue_group[n];
+		slot.pc = pc;
+		slot.fused = can_fuse(pc, queued);
+		slot.station = s;
+		source_slots(instr, slot.sources);
+		slot.producers[0] = slot.producers[1] = UNDEFINED;
+		slot.destination = destination_slot(instr);
+		slot.history = 0;
+		unsigned fallthrough_pc = pc + (slot.fused ? 8 : 4);
+		slot.next_pc = fallthrough_pc;
+		if (fetch_width != 0){
+			if (slot.fused) queued++;
+			slot.next_pc = fetch_queue[queued].next_pc;
+			slot.history = fetch_queue[queued].history;
+			queued++;
+		} else if (slot.fused) slot.next_pc = predict_branch(pc + 4, instr_memory[((pc - instr_base_address) >> 2) + 1].opcode, &slot.history);
+		else if (is_branch(instr.opcode)) slot.next_pc = predict_branch(pc, instr.opcode, &slot.history);
+		pc = slot.next_pc;
+		// a taken prediction ends the issue group (with a front end, it ends the fetch group instead)
+		if (slot.next_pc != fallthrough_pc && fetch_width == 0){
+			n++;
+			break;
+		}
+	}
+	fetch_queue.erase(fetch_queue.begin(), fetch_queue.begin() + queued);
+	return n;
+}
 
-			if(IReg.opcode == MULTS || IReg.opcode == DIVS){
-				bool tag1 = false;
-				bool tag2 = false;
-				for(unsigned i = 0; i < reservation_stations.num_entries; i++){
-					if(reservation_stations.entries[i].instr_exed_this_cycle == false && reservation_stations.entries[i].type == MULT_RS && reservation_stations.entries[i].pc == UNDEFINED){
-						found_rs = i;
-						reservation_stations.entries[found_rs].destination = ROB_nextindex;//IReg.dest; // entry in rob
-						reservation_stations.entries[found_rs].pc = pc;
-						break;
-					}
-				}
-					// push to RS
-
-				if(get_fp_register_tag(IReg.src1) != UNDEFINED) tag1 = true;
-				if(!tag1) {
-					reservation_stations.entries[found_rs].value1 = float2unsigned(get_fp_register(IReg.src1));
-				} else{
-					reservation_stations.entries[found_rs].tag1 = get_fp_register_tag(IReg.src1);
-					// bandaid tc5cc70 div getting wrong tag of mult when add has higher pc and will execute first
-					if(reservation_stations.entries[found_rs].tag1 == 1 && pc == 40) reservation_stations.entries[found_rs].tag1 = 2;
-				}
-
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination - 32 == IReg.src1 && rob.entries[rob_index].ready == true) {
-							reservation_stations.entries[found_rs].value1 = rob.entries[rob_index].value;
-							reservation_stations.entries[found_rs].tag1 = UNDEFINED; 	// erase tag
-						}
-						
-				}
+/* direction from the predictor (JUMP: always taken), target from the BTB (a miss falls through) */
+unsigned sim_ooo::predict_branch(unsigned branch_pc, opcode_t opcode, unsigned long long *history){
+	if (bpred == NULL) return branch_pc + 4;
+	*history = bpred->get_history();
+	bool taken = opcode == JUMP || bpred->predict(branch_pc, history);
+	if (!taken) return branch_pc + 4;
+	unsigned target = btb.lookup(branch_pc);
+	if (target == UNDEFINED){
+		btb_misses++;
+		return branch_pc + 4;
+	}
+	return target;
+}
 
+/* fetch stage: sequential instructions up to the first predicted-taken branch; EOP is queued once, and fetch
+   stops there */
+void sim_ooo::fetch(){
+	if (fetch_pc == UNDEFINED) fetch_pc = pc;
+	// no fetch during the penalty of an early redirect
+	if (clock_cycles < redirect_cycle) return;
+	if (clock_cycles < fetch_restart){
+		fetch_bubbles++;
+		return;
+	}
+	for (unsigned n=0; n<fetch_width && fetch_queue.size()<fetch_queue_size; n++){
+		unsigned index = (fetch_pc - instr_base_address) >> 2;
+		if (loop_end != UNDEFINED && fetch_pc >= loop_start && fetch_pc <= loop_end){
+			// from the loop buffer: decoded, with the branch targets, so taken branches cost nothing
+			instruction_t &instr = instr_memory[index];
+			fetch_entry_t fetched = {fetch_pc, clock_cycles + 1, fetch_pc + 4, 0};
+			if (instr.opcode == JUMP){
+				fetched.history = bpred->get_history();
+				fetched.next_pc = fetch_pc + 4 + instr.immediate;
+			} else if (is_branch(instr.opcode) && bpred->predict(fetch_pc, &fetched.history)) fetched.next_pc = fetch_pc + 4 + instr.immediate;
+			fetch_queue.push_back(fetched);
+			fetched_instructions++;
+			loop_buffer_fetches++;
+			fetch_pc = fetched.next_pc;
+			continue;
+		}
+		if (index >= PROGRAM_SIZE) return;
+		opcode_t opcode = instr_memory[index].opcode;
+		if (opcode == EOP && !fetch_queue.empty() && fetch_queue.back().pc == fetch_pc) return;
+		fetch_entry_t fetched = {fetch_pc, clock_cycles + decode_latency, fetch_pc + 4, 0};
+		if (is_branch(opcode)) fetched.next_pc = predict_branch(fetch_pc, opcode, &fetched.history);
+		fetch_queue.push_back(fetched);
+		if (opcode == EOP) return;
+		fetched_instructions++;
+		fetch_pc = fetched.next_pc;
+		if (bpred != NULL && loop_buffer_size != 0 && loop_buffer_capture(fetched)) continue;
+		if (fetched.next_pc != fetched.pc + 4){
+			fetch_restart = clock_cycles + 1 + taken_branch_bubbles;
+			return;
+		}
+	}
+}
 
-				if(get_fp_register_tag(IReg.src2) != UNDEFINED) tag2 = true;
-				if(!tag2) {
-					reservation_stations.entries[found_rs].value2 = float2unsigned(get_fp_register(IReg.src2));
-				} else{
-					reservation_stations.entries[found_rs].tag2 = get_fp_register_tag(IReg.src2);
-					// bandaid tc5cc70 div getting wrong tag of mult when add has higher pc and will execute first
-					if(reservation_stations.entries[found_rs].tag2 == 1 && pc == 40) reservation_stations.entries[found_rs].tag2 = 2;
-				}
+void sim_ooo::flush_front_end(){
+	fetch_queue.clear();
+	fetch_pc = pc;
+	fetch_restart = 0;
+	loop_branch_pc = UNDEFINED;
+}
 
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination - 32 == IReg.src2 && rob.entries[rob_index].ready == true) {
-							reservation_stations.entries[found_rs].value2 = rob.entries[rob_index].value;
-							reservation_stations.entries[found_rs].tag2 = UNDEFINED; 	// erase tag
-						}
-				}
-			}
+/* the loop buffer keeps its body until another loop is captured */
+bool sim_ooo::loop_buffer_capture(const fetch_entry_t &fetched){
+	if (fetched.next_pc == fetched.pc + 4 || fetched.next_pc > fetched.pc) return false;
+	bool repeats = fetched.pc == loop_branch_pc;
+	loop_branch_pc = fetched.pc;
+	if (!repeats || (fetched.pc - fetched.next_pc) / 4 + 1 > loop_buffer_size) return false;
+	loop_start = fetched.next_pc;
+	loop_end = fetched.pc;
+	return true;
+}
 
+bool sim_ooo::can_fuse(unsigned pc, unsigned queue_index){
+	if (!macro_op_fusion) return false;
+	unsigned index = (pc - instr_base_address) >> 2;
+	if (index + 1 >= PROGRAM_SIZE) return false;
+	instruction_t &op = instr_memory[index];
+	instruction_t &branch = instr_memory[index + 1];
+	if ((op.opcode != ADDI && op.opcode != SUBI) || !is_branch(branch.opcode) || branch.opcode == JUMP || branch.src1 != op.dest) return false;
+	// with a front end, the branch must be decoded as well
+	if (fetch_width != 0){
+		unsigned q = queue_index + 1;
+		return q < fetch_queue.size() && fetch_queue[q].pc == pc + 4 && fetch_queue[q].ready <= clock_cycles;
+	}
+	return true;
+}
 
-			if(is_branch(IReg.opcode)){
-				bool tag = false;
-				for(unsigned i = 0; i < reservation_stations.num_entries; i++){
-					if(reservation_stations.entries[i].instr_exed_this_cycle == false && reservation_stations.entries[i].type == INTEGER_RS && reservation_stations.entries[i].pc == UNDEFINED){
-						found_rs = i;
-						reservation_stations.entries[found_rs].destination = ROB_nextindex;//IReg.dest; // entry in rob
-						reservation_stations.entries[found_rs].pc = pc;
-						break;
-					}
-				}
+instruction_t &sim_ooo::fused_branch(unsigned rob_index){
+	return instr_memory[((rob.entries[rob_index].pc - instr_base_address) >> 2) + 1];
+}
 
-				if(get_int_register_tag(IReg.src1) != UNDEFINED) tag = true;
-				if(!tag) {
-					reservation_stations.entries[found_rs].value1 = (get_int_register(IReg.src1));
-				} else{ 
-					reservation_stations.entries[found_rs].tag1 = get_int_register_tag(IReg.src1);
-				}
+void sim_ooo::log_instruction(unsigned rob_index){
+	commit_to_log(pending_instructions.entries[rob_index]);
+	if (rob.entries[rob_index].fused){
+		instr_window_entry_t branch = pending_instructions.entries[rob_index];
+		branch.pc += 4;
+		commit_to_log(branch);
+	}
+}
 
-				for(int rob_index = 0; rob_index < rob.num_entries; rob_index++){
-						if(rob.entries[rob_index].destination == IReg.src1 && rob.entries[rob_index].ready == true) {
-							reservation_stations.entries[found_rs].value1 = rob.entries[rob_index].value;
-							reservation_stations.entries[found_rs].tag1 = UNDEFINED; 	// erase tag
-						}
-				}
-			}
+/* removes the instructions younger than the one in ROB entry rob_index from the pipeline (they are logged without commit) */
+void sim_ooo::squash_younger(unsigned rob_index){
+	// the younger entries run up to the tail of the ROB (with a full ROB, the tail is the head)
+	for (unsigned r=(rob_index+1)%rob.num_entries; r!=ROB_nextindex; r=(r+1)%rob.num_entries){
+		log_instruction(r);
+		for (unsigned s=0; s<reservation_stations.num_entries; s++)
+			if (reservation_stations.entries[s].pc != UNDEFINED && reservation_stations.entries[s].destination == r) reset_reservation_station(s);
+		for (unsigned u=0; u<num_units; u++)
+			if (exec_units[u].rob_index == r) release_unit(u);
+		opcode_t opcode = rob_instruction(r).opcode;
+		if (opcode == SW || opcode == SWS) lsq_remove(r);
+		else if (opcode == LW || opcode == LWS) lsq_remove_load(r);
+		reset_pending_instruction(r);
+		clean_rob(&rob.entries[r]);
+	}
+	ROB_nextindex = (rob_index + 1) % rob.num_entries;
+	rename_rebuild();
+}
 
+/* COMMIT: up to commit_width instructions retire from the head of the ROB, in program order; retirement stops at
+   the first one that cannot leave the ROB in this clock cycle, and after a flush */
+void sim_ooo::commit(){
+	for (unsigned n=0; n<commit_width; n++)
+		if (!commit_head()) return;
+}
 
-			if(found_rs != UNDEFINED){			
-			// If we found a reservation station & pending instruction:
-				// Push to ROB 
-				if(!is_branch(IReg.opcode))rob.entries[ROB_nextindex].destination = IReg.dest + NUM_GP_REGISTERS;
-				if(is_int(IReg.opcode)) rob.entries[ROB_nextindex].destination = IReg.dest; //fp
-
-				rob.entries[ROB_nextindex].pc = pc;
-				rob.entries[ROB_nextindex].ready = false;
-				rob.entries[ROB_nextindex].state = ISSUE;
-				rob.entries[ROB_nextindex].value = UNDEFINED;
-			
-				// Push to pending instruction list
-				pending_instructions.entries[PI_headptr].pc = pc;
-				pending_instructions.entries[PI_headptr].issue = clock_cycles;
-				instr_memory[real_pc].pending_index = PI_headptr; 
-				instr_memory[real_pc].rob_index = ROB_nextindex;
-
-				ROB_nextindex++;
-				if(ROB_nextindex == rob.num_entries) ROB_nextindex = 0;
-				PI_headptr++;
-				if(PI_headptr == pending_instructions.num_entries) PI_headptr = 0;
-				real_pc++;
-				pc = real_pc * 4 + instr_base_address;
+/* the instruction at the head of the ROB retires once its result was written (in an earlier clock cycle)
+   - a store writes the memory through a memory unit and keeps the head of the ROB until the write completes
+   - a taken branch squashes all the younger instructions and redirects the issue to its target */
+bool sim_ooo::commit_head(){
+	unsigned r = ROB_headptr;
+	rob_entry_t &entry = rob.entries[r];
+	if (entry.pc == UNDEFINED) return false;
+	instruction_t &instr = rob_instruction(r);
+	if (!entry.store_committed){
+		if (!entry.ready || pending_instructions.entries[r].wr == clock_cycles) return false;
+		if (entry.load_violated){
+			memory_order_squash();
+			return false;
+		}
+		if ((instr.opcode == SW || instr.opcode == SWS) && store_buffer_size > 0){
+			if (!store_buffer_insert(r)){
+				store_commit_stalls++;
+				return false;
 			}
-
-			// if no free reservation station (structural hazard), 
-			// can't do anything - don't advance pc
-		// --------------------------- END ISSUE --------------------------- 
-		//}
+			entry.store_committed = true;
+			entry.store_exit_cc = clock_cycles;
+		}else if (instr.opcode == SW || instr.opcode == SWS){
+			unsigned unit = get_free_unit(instr.opcode);
+			if (unit == UNDEFINED || !memory_port_reserve(true, entry.destination)){
+				store_commit_stalls++;
+				return false;
+			}
+			bool unit_bound;
+			unsigned latency = memory_access_latency(unit, entry.destination, true, &unit_bound);
+			occupy_unit(unit, r, latency - 1, unit_bound);
+			entry.store_committed = true;
+			entry.store_exit_cc = clock_cycles + latency - 1;
+			entry.store_mem_unit_index = unit;
+		}
+		entry.state = COMMIT;
+		pending_instructions.entries[r].commit = clock_cycles;
+		instructions_executed++;
+		// a fused pair retires both instructions
+		if (entry.fused){
+			instructions_executed++;
+			fused_pairs++;
 		}
 	}
+	if (entry.store_committed && clock_cycles < entry.store_exit_cc){
+		store_commit_stalls++;
+		return false;
+	}
+	retire_head();
+	return true;
+}
 
+/* retires the instruction at the head of the ROB: its result goes to the register file or to the memory */
+void sim_ooo::retire_head(){
+	unsigned r = ROB_headptr;
+	rob_entry_t &entry = rob.entries[r];
+	instruction_t &instr = rob_instruction(r);
+	if (entry.store_committed){
+		write_memory(entry.destination, entry.value);
+		lsq_remove(r);
+	}else if (writes_int_register(instr.opcode)){
+		int_registers[instr.dest] = entry.value;
+	}else if (writes_fp_register(instr.opcode)){
+		fp_registers[instr.dest] = unsigned2float(entry.value);
+	}
+	// the register file holds the value from now on, unless a younger writer was issued
+	unsigned slot = destination_slot(instr);
+	if (slot != UNDEFINED && rename_map[slot] == r) rename_map[slot] = UNDEFINED;
+	if (instr.opcode == LW || instr.opcode == LWS) lsq_remove_load(r);
+	// a fused pair resolves the branch after the ALU operation
+	unsigned branch_pc = entry.fused ? entry.pc + 4 : entry.pc;
+	unsigned next_pc = entry.fused ? entry.branch_target : entry.value;
+	if (is_branch(instr.opcode) || entry.fused){
+		branches++;
+		if (entry.mispredicted) branch_mispredictions++;
+		if (entry.redirected) early_redirects++;
+		if (bpred != NULL){
+			if (instr.opcode != JUMP) bpred->update(branch_pc, entry.branch_taken, entry.branch_history);
+			if (entry.branch_taken) btb.update(branch_pc, next_pc);
+		}
+	}
+	log_instruction(r);
+	reset_pending_instruction(r);
+	ROB_headptr = (r + 1) % rob.num_entries;
+	if (entry.mispredicted && !entry.redirected){
+		// the ROB is empty after the flush: allocation restarts from its first entry
+		squash_younger(r);
+		pc = next_pc;
+		flush_front_end();
+		ROB_headptr = ROB_nextindex = 0;
+		store_sets.clear_lfst();
+		if (bpred != NULL) bpred->recover();
+		// the functional model is on the target path: resume binding its instructions
+		on_correct_path = true;
+	}
+	clean_rob(&entry);
+}
 
+/* store buffer: a committing store is combined into the waiting entry of its line(s), or takes a new one */
+bool sim_ooo::store_buffer_insert(unsigned rob_index){
+	unsigned address = rob.entries[rob_index].destination;
+	unsigned lines[2] = {address & ~(store_buffer_line - 1), (address + 3) & ~(store_buffer_line - 1)};
+	unsigned count = lines[1] != lines[0] ? 2 : 1;
+	unsigned waiting[2] = {UNDEFINED, UNDEFINED};
+	unsigned needed = 0;
+	for (unsigned k=0; k<count; k++){
+		for (unsigned i=0; i<store_buffer.size(); i++)
+			if (store_buffer[i].line == lines[k] && store_buffer[i].unit == UNDEFINED) waiting[k] = i;
+		if (waiting[k] == UNDEFINED) needed++;
+	}
+	if (store_buffer.size() + needed > store_buffer_size) return false;
+	bool combined = false;
+	for (unsigned k=0; k<count; k++){
+		unsigned long long mask = 0;
+		for (unsigned i=0; i<4; i++)
+			if (((address + i) & ~(store_buffer_line - 1)) == lines[k]) mask |= 1ULL << (address + i - lines[k]);
+		if (waiting[k] != UNDEFINED){
+			store_buffer[waiting[k]].mask |= mask;
+			combined = true;
+		}else{
+			store_buffer_entry_t entry = {lines[k], mask, UNDEFINED, UNDEFINED};
+			store_buffer.push_back(entry);
+		}
+	}
+	if (combined) combined_stores++;
+	return true;
+}
 
+sim_ooo::store_buffer_lookup_t sim_ooo::store_buffer_lookup(unsigned address){
+	unsigned covered = 0;
+	for (unsigned i=0; i<4; i++){
+		unsigned line = (address + i) & ~(store_buffer_line - 1);
+		for (unsigned b=0; b<store_buffer.size(); b++){
+			if (store_buffer[b].line == line && ((store_buffer[b].mask >> (address + i - line)) & 1)){
+				covered++;
+				break;
+			}
+		}
+	}
+	return covered == 0 ? SB_MISS : (covered == 4 ? SB_HIT : SB_PARTIAL);
+}
 
+/* the waiting lines are written in commit order by the memory units still free in this clock cycle;
+   a line leaves the buffer in the clock cycle its write completes (like a store holding the ROB head) */
+void sim_ooo::store_buffer_drain(){
+	for (unsigned i=0; i<store_buffer.size(); i++){
+		store_buffer_entry_t &entry = store_buffer[i];
+		if (entry.unit != UNDEFINED) continue;
+		unsigned unit = get_free_unit(SW);
+		if (unit == UNDEFINED || !memory_port_reserve(true, entry.line)) break;
+		bool unit_bound;
+		unsigned latency = memory_access_latency(unit, entry.line, true, &unit_bound);
+		occupy_unit(unit, STORE_BUFFER_DRAIN, latency - 1, unit_bound);
+		entry.unit = unit;
+		entry.done = clock_cycles + latency - 1;
+	}
+	for (unsigned i=0; i<store_buffer.size(); ){
+		if (store_buffer[i].unit != UNDEFINED && store_buffer[i].done <= clock_cycles) store_buffer.erase(store_buffer.begin() + i);
+		else i++;
+	}
+}
 
+/* memory ports: a port of the right kind and the bank of the address must be free in this clock cycle */
+bool sim_ooo::memory_port_reserve(bool write, unsigned address){
+	if (load_ports == 0) return true;
+	unsigned &used = write ? stores_this_cycle : loads_this_cycle;
+	if (used == (write ? store_ports : load_ports)){
+		port_stalls++;
+		return false;
+	}
+	if (address != UNDEFINED){
+		unsigned bank = (address / bank_interleave) % num_banks;
+		if (bank_cycle[bank] == clock_cycles){
+			bank_conflicts++;
+			return false;
+		}
+		bank_cycle[bank] = clock_cycles;
+	}
+	used++;
+	if (write) store_port_accesses++;
+	else load_port_accesses++;
+	return true;
+}
 
+/* memory order violation: the load at the head of the ROB read a stale value; it is squashed with all the
+   younger instructions (logged without commit) and the issue restarts from it */
+void sim_ooo::memory_order_squash(){
+	unsigned r = ROB_headptr;
+	unsigned load_pc = rob.entries[r].pc;
+	memory_violations++;
+	// functional-first: the dynamic instructions bound to the squashed entries are issued again, in order
+	if (oracle != NULL){
+		deque<dyn_instr_t> replay;
+		for (unsigned i=0, e=r; i<rob.num_entries && rob.entries[e].pc!=UNDEFINED && rob_oracle_valid[e]; i++, e=(e+1)%rob.num_entries){
+			replay.push_back(rob_oracle[e]);
+			if (rob.entries[e].fused) replay.push_back(rob_oracle_branch[e]);
+		}
+		if (oracle_has_next) replay.push_back(oracle_next);
+		oracle_has_next = false;
+		replay.insert(replay.end(), oracle_replay.begin(), oracle_replay.end());
+		oracle_replay.swap(replay);
+		on_correct_path = true;
+	}
+	commit_to_log(pending_instructions.entries[r]);
+	squash_younger(r);
+	for (unsigned u=0; u<num_units; u++)
+		if (exec_units[u].rob_index == r) release_unit(u);
+	lsq_remove_load(r);
+	reset_pending_instruction(r);
+	clean_rob(&rob.entries[r]);
+	store_sets.clear_lfst();
+	if (bpred != NULL) bpred->recover();
+	pc = load_pc;
+	flush_front_end();
+	ROB_headptr = ROB_nextindex = 0;
+	rename_rebuild();
+}
 
-	// bandaids (squashed memory problems)
-	for(unsigned i = 0; i < pending_instructions.num_entries; i++){
-		if(pending_instructions.entries[i].pc == UNDEFINED) reset_pending_instruction(i);
-		if(pending_instructions.entries[i].wr == UNDEFINED) pending_instructions.entries[i].commit = UNDEFINED;
-		if(pending_instructions.entries[i].commit >= 1000000) pending_instructions.entries[i].commit = UNDEFINED;
+/* core of the simulator */
+void sim_ooo::run(unsigned cycles){
+	// functional-first: start the functional model from the current architectural state
+	if (functional_first && oracle == NULL && !finished){
+		unsigned registers[NUM_GP_REGISTERS * 2];
+		for (unsigned i=0; i<NUM_GP_REGISTERS; i++){
+			registers[i] = int_registers[i];
+			registers[i + NUM_GP_REGISTERS] = float2unsigned(fp_registers[i]);
+		}
+		oracle = new sim_func(instr_memory, instr_base_address, registers, *data_memory, oracle_queue_size);
+		oracle->start();
 	}
-	if(int_fp_registers[31] < -2000000000) int_fp_registers[31] = UNDEFINED;
-	if(instr_memory[10].opcode == ADDS && pc!=0 && branched_this_cycle){
-		instr_window_entry_t bonus;
-		bonus.pc = 40;
-		bonus.exe = UNDEFINED;
-		bonus.wr = UNDEFINED;
-		bonus.commit = UNDEFINED;
-		bonus.issue = clock_cycles;
-		commit_to_log(bonus);
+	for (unsigned c=0; !finished && (cycles == 0 || c < cycles); c++){
+		dispatched_units = 0;
+		loads_this_cycle = stores_this_cycle = 0;
+		// a unit is busy until the end of the clock cycle in which its count reaches 0
+		for (unsigned u=0; u<num_units; u++){
+			if (exec_units[u].busy > 0) exec_units[u].busy--;
+			else if (exec_units[u].rob_index != UNDEFINED) release_unit(u);
+		}
+		execute();
+		write_result();
+		issue();
+		commit();
+		if (!store_buffer.empty()) store_buffer_drain();
+		if (dram.enabled()) dram_tick();
+		if (fetch_width != 0) fetch();
+		check_finished();
+		clock_cycles++;
 	}
+}
 
-	}
+/* the program is over once the issue reached EOP, the ROB is empty and the store buffer is written */
+void sim_ooo::check_finished(){
+	if (instr_memory[(pc - instr_base_address) >> 2].opcode == EOP && rob.entries[ROB_headptr].pc == UNDEFINED && store_buffer.empty()) finished = true;
 }
 
 //reset the state of the simulator - please complete
 void sim_ooo::reset(){
 
 	//init instruction log
+	log.str("");
 	init_log();	
 
-	// data memory
-	for (unsigned i=0; i<data_memory_size; i++) data_memory[i]=0xFF;
+	// data memory (a shared memory is cleared by its owner)
+	if (owns_data_memory) data_memory->clear();
 	
 	//instr memory
 	for (int i=0; i<PROGRAM_SIZE;i++){
@@ -1222,19 +1990,14 @@ void sim_ooo::reset(){
 		instr_memory[i].src2=UNDEFINED;
 		instr_memory[i].dest=UNDEFINED;
 		instr_memory[i].immediate=UNDEFINED;
-		instr_memory[i].pending_index = UNDEFINED; // new
-		instr_memory[i].rob_index = UNDEFINED; // new
 	}
 
 	//general purpose registers
 	for(int i = 0; i < NUM_GP_REGISTERS; i++){
-		//fp_registers[i] = UNDEFINED;
-		int_fp_registers[i] = (int)UNDEFINED;
-	}
-	for(int i = 0; i < NUM_GP_REGISTERS; i++){
-		//fp_registers[i] = UNDEFINED;
-		set_fp_register(i,UNDEFINED);
+		set_int_register(i, UNDEFINED);
+		set_fp_register(i, UNDEFINED);
 	}
+
 	//pending_instructions
 	for(unsigned i = 0; i < pending_instructions.num_entries;i++){
 		reset_pending_instruction(i);
@@ -1242,152 +2005,330 @@ void sim_ooo::reset(){
 
 	//rob
 	for(unsigned i=0; i< rob.num_entries;i++){
-		//rob_entry_t * current = rob.entries[i];
 		clean_rob(&rob.entries[i]);
 	}
+	for (unsigned i=0; i<NUM_GP_REGISTERS * 2; i++) rename_map[i] = UNDEFINED;
+
 	//reservation_stations
 	for(unsigned i=0; i< reservation_stations.num_entries;i++){
 		reset_reservation_station(i);
+		reservation_stations.entries[i].released = UNDEFINED;
 	}
 
+	//execution units
+	for(unsigned u=0; u<num_units; u++){
+		release_unit(u);
+		exec_units[u].started = UNDEFINED;
+	}
 
 	//execution statistics
-	clock_cycles = -1;
+	clock_cycles = 0;
 	instructions_executed = 0;
-	
+	rob_full_stalls = 0;
+	rs_full_stalls = 0;
+	forwarded_loads = 0;
+	disambiguation_stalls = 0;
+	lsq_index.clear();
+	lsq_unresolved = 0;
+	store_sets.flush();
+	lsq_load_index.clear();
+	memory_violations = 0;
+	false_dependences = 0;
+	store_buffer.clear();
+	store_commit_stalls = 0;
+	combined_stores = 0;
+	bank_cycle.assign(num_banks, UNDEFINED);
+	loads_this_cycle = 0;
+	stores_this_cycle = 0;
+	load_port_accesses = 0;
+	store_port_accesses = 0;
+	port_stalls = 0;
+	bank_conflicts = 0;
+	cdb_broadcasts = 0;
+	cdb_conflicts = 0;
+	if (bpred != NULL){
+		delete bpred;
+		bpred = sim_bpred::create(bpred_type, bpred_entries, bpred_history_bits);
+	}
+	btb.flush();
+	branches = 0;
+	branch_mispredictions = 0;
+	btb_misses = 0;
+	redirect_cycle = 0;
+	early_redirects = 0;
+	redirect_stalls = 0;
+	fetch_queue.clear();
+	fetch_pc = UNDEFINED;
+	fetch_restart = 0;
+	frontend_stalls = 0;
+	fetch_bubbles = 0;
+	fetched_instructions = 0;
+	loop_branch_pc = UNDEFINED;
+	loop_end = UNDEFINED;
+	loop_buffer_fetches = 0;
+	fused_pairs = 0;
+	dispatched_units = 0;
+	dtlb.flush();
+	for (unsigned i=0; i<dcache.size(); i++) dcache[i].flush();
+	if (reuse != NULL) reuse->clear();
+	dram.flush();
+	dram_waits.clear();
+
+	//functional model (restarted by the next run)
+	delete oracle;
+	oracle = NULL;
+	oracle_has_next = false;
+	oracle_replay.clear();
+	on_correct_path = true;
+	for (unsigned i=0; i<rob.num_entries; i++) rob_oracle_valid[i] = false;
 
 	//other required initializations
-	null_inst.dest = UNDEFINED;
-	null_inst.immediate = UNDEFINED;
-	//null_inst.label = "";
-	null_inst.opcode = NOP;
-	null_inst.src1 = UNDEFINED;
-	null_inst.src2 = UNDEFINED;
-	null_inst.pending_index = UNDEFINED;
-	null_inst.rob_index = UNDEFINED;
-
-	IReg.dest = UNDEFINED;
-	IReg.immediate = UNDEFINED;
-	//null_inst.label = "";
-	IReg.opcode = NOP;
-	IReg.src1 = UNDEFINED;
-	IReg.src2 = UNDEFINED;
-	IReg.pending_index = UNDEFINED;
-	IReg.rob_index = UNDEFINED;
-	
-	real_pc = 0;
+	pc = instr_base_address;
 	ROB_headptr = 0;
-	PI_headptr = 0;
 	ROB_nextindex = 0;
 
-	last_instruction_pc = UNDEFINED;
-
 	finished = false;
 }
 
+/* functional-first simulation */
+
+void sim_ooo::set_functional_first(bool enable, unsigned queue_size){
+	functional_first = enable;
+	oracle_queue_size = queue_size;
+	if (!enable){
+		delete oracle;
+		oracle = NULL;
+		oracle_has_next = false;
+		oracle_replay.clear();
+		for (unsigned i=0; i<rob.num_entries; i++) rob_oracle_valid[i] = false;
+	}
+}
+
+void sim_ooo::set_store_forwarding_latency(unsigned latency){
+	if (latency == 0) throw sim_error("store forwarding latency must be at least 1 clock cycle!");
+	store_forwarding_latency = latency;
+}
+
+void sim_ooo::set_store_buffer(unsigned entries, unsigned line_size){
+	if (!is_power_of_2(line_size) || line_size < 4 || line_size > 64) throw sim_error("store buffer line size must be a power of 2 between 4 and 64 bytes!");
+	store_buffer_size = entries;
+	store_buffer_line = line_size;
+}
+
+void sim_ooo::set_memory_ports(unsigned load_ports, unsigned store_ports, unsigned banks, unsigned interleave){
+	if (load_ports > 0 && (store_ports == 0 || banks == 0 || !is_power_of_2(interleave)))
+		throw sim_error("memory ports need at least one store port and one bank, interleaved by a power of 2!");
+	this->load_ports = load_ports;
+	this->store_ports = store_ports;
+	num_banks = banks == 0 ? 1 : banks;
+	bank_interleave = interleave;
+	bank_cycle.assign(num_banks, UNDEFINED);
+}
+
+void sim_ooo::set_cdbs(unsigned num_cdbs, cdb_arbitration_t arbitration){
+	this->num_cdbs = num_cdbs;
+	cdb_arbitration = arbitration;
+}
+
+void sim_ooo::init_branch_predictor(branch_predictor_t type, unsigned entries, unsigned history_bits,
+				    unsigned btb_entries, unsigned btb_associativity){
+	sim_bpred *predictor = sim_bpred::create(type, entries, history_bits);
+	try{
+		btb.init(btb_entries, btb_associativity);
+	}catch (const sim_error &e){
+		delete predictor;
+		throw;
+	}
+	delete bpred;
+	bpred = predictor;
+	bpred_type = type;
+	bpred_entries = entries;
+	bpred_history_bits = history_bits;
+}
+
+void sim_ooo::set_early_branch_resolution(bool enable, unsigned penalty){
+	early_branch_resolution = enable;
+	redirect_penalty = penalty;
+}
+
+void sim_ooo::init_front_end(unsigned fetch_width, unsigned queue_size, unsigned taken_branch_bubbles, unsigned decode_latency){
+	if (fetch_width == 0 || queue_size == 0 || decode_latency == 0)
+		throw sim_error("fetch width, fetch queue size and decode latency must be non-zero!");
+	this->fetch_width = fetch_width;
+	fetch_queue_size = queue_size;
+	this->taken_branch_bubbles = taken_branch_bubbles;
+	this->decode_latency = decode_latency;
+	fetch_queue.clear();
+	fetch_pc = UNDEFINED;
+}
+
+void sim_ooo::enable_memory_speculation(unsigned ssit_entries, unsigned lfst_entries){
+	store_sets.init(ssit_entries, lfst_entries);
+}
+
+/* data TLB */
+
+void sim_ooo::init_tlb(unsigned entries, unsigned associativity, unsigned page_size, unsigned walk_level_latency){
+	dtlb.init(entries, associativity, page_size, walk_level_latency);
+}
+
+/* data cache hierarchy */
+
+void sim_ooo::add_cache_level(unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency,
+			      replacement_t policy, unsigned mshrs){
+	dcache.push_back(sim_cache(size, associativity, line_size, hit_latency, policy, mshrs));
+}
+
+/* DRAM */
+
+void sim_ooo::init_dram(unsigned channels, unsigned banks, unsigned row_size, row_policy_t policy,
+			unsigned tRCD, unsigned tCAS, unsigned tRP, unsigned burst, unsigned line_size, unsigned queue_size){
+	dram.init(channels, banks, row_size, policy, tRCD, tCAS, tRP, burst, line_size, queue_size);
+	dram_waits.clear();
+}
+
+void sim_ooo::dram_tick(){
+	vector<sim_dram::dram_completion_t> issued;
+	dram.tick(clock_cycles, issued);
+	for (unsigned i=0; i<issued.size(); i++){
+		unsigned done = issued[i].done;
+		for (unsigned w=0; w<dram_waits.size(); w++){
+			if (dram_waits[w].id != issued[i].id) continue;
+			for (unsigned l=0; l<dram_waits[w].levels; l++) dcache[l].fill(issued[i].address, dram_waits[w].write && l == 0, done);
+			dram_waits.erase(dram_waits.begin() + w);
+			break;
+		}
+		// the access completes at "done" (a store leaves the ROB in the clock cycle before);
+		// a unit released in the meantime (squashed access) is left alone
+		for (unsigned u=0; u<num_units; u++){
+			if (exec_units[u].dram_request != issued[i].id) continue;
+			unsigned r = exec_units[u].rob_index;
+			exec_units[u].dram_request = UNDEFINED;
+			if (r == STORE_BUFFER_DRAIN){
+				for (unsigned b=0; b<store_buffer.size(); b++)
+					if (store_buffer[b].unit == u) store_buffer[b].done = done - 1;
+				exec_units[u].busy = done - 1 - clock_cycles;
+			}else if (rob.entries[r].store_committed){
+				rob.entries[r].store_exit_cc = done - 1;
+				exec_units[u].busy = done - 1 - clock_cycles;
+			}else{
+				for (unsigned s=0; s<reservation_stations.num_entries; s++)
+					if (reservation_stations.entries[s].pc != UNDEFINED && reservation_stations.entries[s].destination == r)
+						reservation_stations.entries[s].wr_cycle = done;
+				exec_units[u].busy = done - clock_cycles;
+			}
+		}
+	}
+}
+
+void sim_ooo::enable_reuse_analysis(unsigned line_size, unsigned max_sets, unsigned max_associativity){
+	sim_reuse *analysis = new sim_reuse(line_size, max_sets, max_associativity);
+	delete reuse;
+	reuse = analysis;
+}
+
+sim_reuse *sim_ooo::get_reuse_analysis(){return reuse;}
+
+unsigned sim_ooo::memory_access_latency(unsigned unit, unsigned address, bool write, bool *unit_bound){
+	if (reuse != NULL) reuse->access(address);
+	unsigned latency = dtlb.access(address);
+	*unit_bound = true;
+
+	// walk down the hierarchy until a level hits (or main memory is reached; without caches every access does)
+	unsigned time = clock_cycles + latency;
+	unsigned level = 0;
+	bool hit = false;
+	while (level < dcache.size() && !hit){
+		time += dcache[level].probe(address, write, time, &hit);
+		if (!hit) level++;
+	}
+	if (!hit && dram.enabled()){
+		// wait for the DRAM: the time is set by dram_tick() once the request is scheduled
+		dram_wait_t wait = {dram.enqueue(address, time), level, write};
+		dram_waits.push_back(wait);
+		exec_units[unit].dram_request = wait.id;
+		*unit_bound = false;
+		return DRAM_PENDING;
+	}
+	if (!hit) time += exec_units[unit].latency;
+	else *unit_bound = false;
+	// the levels that missed get the line once it arrives
+	for (unsigned i=0; i<level && i<dcache.size(); i++) dcache[i].fill(address, write && i == 0, time);
+	return time - clock_cycles;
+}
+
+void sim_ooo::bind_oracle(unsigned rob_index){
+	rob_oracle_valid[rob_index] = false;
+	unsigned instr_pc = rob.entries[rob_index].pc;
+	if (oracle == NULL || !on_correct_path || !oracle_take(instr_pc, &rob_oracle[rob_index])) return;
+	// a fused pair also takes the dynamic instruction of its branch
+	rob_oracle_valid[rob_index] = !rob.entries[rob_index].fused || oracle_take(instr_pc + 4, &rob_oracle_branch[rob_index]);
+}
+
+bool sim_ooo::oracle_take(unsigned instr_pc, dyn_instr_t *dyn){
+	if (!oracle_has_next && !oracle_replay.empty()){
+		oracle_next = oracle_replay.front();
+		oracle_replay.pop_front();
+		oracle_has_next = true;
+	}
+	if (!oracle_has_next) oracle_has_next = oracle->next(&oracle_next);
+	if (!oracle_has_next || oracle_next.pc != instr_pc){
+		on_correct_path = false; // wrong path (or end of the dynamic stream)
+		return false;
+	}
+	*dyn = oracle_next;
+	oracle_has_next = false;
+	return true;
+}
+
+dyn_instr_t *sim_ooo::oracle_instr(unsigned rob_index){
+	return rob_oracle_valid[rob_index] ? &rob_oracle[rob_index] : NULL;
+}
+
 /* registers related */
 
 int sim_ooo::get_int_register(unsigned reg){
-	return int_fp_registers[reg]; 
+	return int_registers[reg]; 
 }
 
 void sim_ooo::set_int_register(unsigned reg, int value){
-	int_fp_registers[reg] = (float)value;
+	int_registers[reg] = value;
 }
 
 float sim_ooo::get_fp_register(unsigned reg){
-	return int_fp_registers[reg + NUM_GP_REGISTERS];
+	return fp_registers[reg];
 }
 
 void sim_ooo::set_fp_register(unsigned reg, float value){
-	int_fp_registers[reg + NUM_GP_REGISTERS] = value;
-}
-
-unsigned sim_ooo::get_int_register_tag(unsigned reg){ // for now, get_*_register_tag functions return value of register
-	// find latest issued instruction on pending
-	int current_latest_cycle = UNDEFINED;
-	unsigned pindex = UNDEFINED;
-	unsigned rval = UNDEFINED;
-	for(int i = 0; i < pending_instructions.num_entries; i++){
-		if(instr_memory[(pending_instructions.entries[i].pc - instr_base_address) / 4].dest == reg && ((int)pending_instructions.entries[i].issue > (int)current_latest_cycle)){
-			if(is_int(instr_memory[(pending_instructions.entries[i].pc - instr_base_address) / 4].opcode)){
-				current_latest_cycle = pending_instructions.entries[i].issue;
-				pindex = i;
-			}
-		}
-	}
-	if(pindex != UNDEFINED) rval = (instr_memory[(pending_instructions.entries[pindex].pc - instr_base_address)/4].rob_index);
-	return rval;
+	fp_registers[reg] = value;
 }
 
-unsigned sim_ooo::get_fp_register_tag(unsigned reg){
+/* returns the latest ROB entry (in program order) that writes the register in slot (R0-R31, then F0-F31) */
+unsigned sim_ooo::rename_lookup(unsigned slot){
+	return rename_map[slot];
+}
 
-	// find latest issued instruction on pending
-	int current_latest_cycle = UNDEFINED;
-	unsigned pindex = UNDEFINED;
-	unsigned rval = UNDEFINED;
-	for(int i = 0; i < pending_instructions.num_entries; i++){
-		if(!is_int(instr_memory[(pending_instructions.entries[i].pc - instr_base_address) / 4].opcode) && instr_memory[(pending_instructions.entries[i].pc - instr_base_address) / 4].dest == reg && ((int)pending_instructions.entries[i].issue > (int)current_latest_cycle)){
-			current_latest_cycle = pending_instructions.entries[i].issue;
-			pindex = i;
-		}
+/* the latest writer of each register among the instructions in the ROB, in program order */
+void sim_ooo::rename_rebuild(){
+	for (unsigned i=0; i<NUM_GP_REGISTERS * 2; i++) rename_map[i] = UNDEFINED;
+	for (unsigned i=0, r=ROB_headptr; i<rob.num_entries && rob.entries[r].pc!=UNDEFINED; i++, r=(r+1)%rob.num_entries){
+		unsigned slot = destination_slot(rob_instruction(r));
+		if (slot != UNDEFINED) rename_map[slot] = r;
 	}
-	if(pindex != UNDEFINED) rval = (instr_memory[(pending_instructions.entries[pindex].pc - instr_base_address)/4].rob_index);
-	return rval;
+}
+
+unsigned sim_ooo::get_int_register_tag(unsigned reg){
+	return rename_lookup(reg);
+}
+
+unsigned sim_ooo::get_fp_register_tag(unsigned reg){
+	return rename_lookup(reg + NUM_GP_REGISTERS);
 }
 
 void sim_ooo::reset_pending_instruction(unsigned i){
-		pending_instructions.entries[i].commit = UNDEFINED;
-		pending_instructions.entries[i].exe = UNDEFINED;
-		pending_instructions.entries[i].issue = UNDEFINED;
-		pending_instructions.entries[i].pc = UNDEFINED;
-		pending_instructions.entries[i].wr = UNDEFINED;
-		pending_instructions.entries[i].released_this_cycle = false;
+	clean_instr_window(&pending_instructions.entries[i]);
 }
 
 void sim_ooo::reset_reservation_station(unsigned i){
-	reservation_stations.entries[i].address = UNDEFINED;
-	reservation_stations.entries[i].destination = UNDEFINED;
-	reservation_stations.entries[i].pc = UNDEFINED;
-	reservation_stations.entries[i].tag1 = UNDEFINED;
-	reservation_stations.entries[i].tag2 = UNDEFINED;
-	reservation_stations.entries[i].value1 = UNDEFINED;
-	reservation_stations.entries[i].value2 = UNDEFINED;
-	reservation_stations.entries[i].received_tag_this_cycle = false;
-	reservation_stations.entries[i].instr_exed_this_cycle = false;
-	reservation_stations.entries[i].instr_has_been_exed = false;
-}
-
-
-
-bool sim_ooo::isALUorSTORE(instruction_t i){
-	return (
-		i.opcode == SWS ||
-		i.opcode == SW ||
-		i.opcode == ADD ||
-		i.opcode == ADDI ||
-		i.opcode == SUB ||
-		i.opcode == SUBI ||
-		i.opcode == XOR ||
-		i.opcode == AND ||
-		i.opcode == MULT ||
-		i.opcode == DIV ||
-		i.opcode == SWS ||
-		i.opcode == ADDS ||
-		i.opcode == SUBS ||
-		i.opcode == MULTS ||
-		i.opcode == DIVS
-	);
-}
-
-
-bool sim_ooo::isBRANCH(instruction_t i){
-	return(
-		i.opcode == BEQZ ||
-		i.opcode == BGEZ ||
-		i.opcode == BGTZ ||
-		i.opcode == BLEZ || 
-		i.opcode == BLTZ ||
-		i.opcode == BNEZ
-	);
-}
\ No newline at end of file
+	clean_res_station(&reservation_stations.entries[i]);
+}
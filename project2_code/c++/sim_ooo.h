@@ -6,16 +6,38 @@
 #include <string>
 #include <cstring>
 #include <sstream>
+#include <iostream>
+#include <stdexcept>
+#include <map>
+#include <deque>
+#include "sim_memory.h"
+#include "sim_tlb.h"
+#include "sim_cache.h"
+#include "sim_reuse.h"
+#include "sim_dram.h"
+#include "sim_storeset.h"
+#include "sim_bpred.h"
 
 using namespace std;
 
 #define UNDEFINED 0xFFFFFFFF // constant used for initialization
+#define STORE_BUFFER_DRAIN 0xFFFFFFFE // "ROB entry" of a memory unit draining the store buffer
 #define NUM_GP_REGISTERS 32
 #define NUM_OPCODES 24
 #define NUM_STAGES 4
 #define MAX_UNITS 10 
+#define MAX_UNIT_ENTRIES 32 // entries of exec_units (a pipelined unit takes one per operation in flight)
 #define PROGRAM_SIZE 50 
 
+// error raised by the simulator (invalid program or configuration)
+// the simulator never terminates the process: callers decide how to handle the error
+class sim_error : public runtime_error{
+public:
+	sim_error(const string &message) : runtime_error(message) {}
+};
+#define NUM_UNIT_TYPES 5 // one per exe_unit_t
+#define NUM_RS_TYPES 4 // one per res_station_t
+
 // instructions supported
 typedef enum {LW, SW, ADD, ADDI, SUB, SUBI, XOR, AND, MULT, DIV, BEQZ, BNEZ, BLTZ, BGTZ, BLEZ, BGEZ, JUMP, EOP, LWS, SWS, ADDS, SUBS, MULTS, DIVS, NOP} opcode_t;
 
@@ -25,6 +47,9 @@ typedef enum {INTEGER_RS, ADD_RS, MULT_RS, LOAD_B} res_station_t;
 // execution units types
 typedef enum {INTEGER, ADDER, MULTIPLIER, DIVIDER, MEMORY} exe_unit_t;
 
+// common data bus arbitration: oldest instruction first, or fixed priority in the order the units were added
+typedef enum {OLDEST_FIRST, UNIT_ORDER} cdb_arbitration_t;
+
 // stages names
 typedef enum {ISSUE, EXECUTE, WRITE_RESULT, COMMIT} stage_t;
 
@@ -36,8 +61,6 @@ typedef struct{
         unsigned dest; //destination register
         unsigned immediate; //immediate field
         string label; //for conditional branches, label of the target instruction - used only for parsing/debugging purposes
-		unsigned pending_index; // holds location on pending instructions board
-		unsigned rob_index;
 } instruction_t;
 
 // execution unit
@@ -49,8 +72,12 @@ typedef struct{
                           // to the latency of the unit when the unit becomes busy, and decremented
                           // at each clock cycle
         unsigned pc; 	  // PC of the instruction using the functional unit
-		unsigned result;  // result
-		bool released_this_cycle;
+		unsigned rob_index; // ROB entry of the instruction using the unit (UNDEFINED if the unit is free,
+				    // STORE_BUFFER_DRAIN if the memory unit writes a line of the store buffer)
+		unsigned dram_request; // main memory request the (memory) unit is waiting for (UNDEFINED if none)
+		unsigned initiation_interval; // pipelined unit: clock cycles between two operations (0: unpipelined)
+		unsigned pipeline; // pipelined unit: first entry of exec_units holding its operations
+		unsigned started; // first entry of a pipelined unit: clock cycle in which its last operation started
 } unit_t;
 
 // entry in the "instruction window"
@@ -60,7 +87,6 @@ typedef struct{
 	unsigned exe;	// clock cycle when the instruction enters execution
 	unsigned wr;	// clock cycle when the instruction enters write result
 	unsigned commit;// clock cycle when the instruction commits (for stores, clock cycle when the store starts committing 
-	bool released_this_cycle;
 } instr_window_entry_t;
 
 // ROB entry
@@ -70,10 +96,22 @@ typedef struct{
 	stage_t state;	// state field
 	unsigned destination; // destination field
 	unsigned value;	      // value field
-	bool branch_taken;
+	bool branch_taken;	// branches: the branch is taken
+	unsigned predicted_pc;	// branches: pc the issue continued at after the branch
+	unsigned long long branch_history; // branches: global history the direction was predicted with
+	bool mispredicted;	// branches: the next pc differs from predicted_pc (the younger instructions are squashed at commit)
+	bool redirected;	// branches: the misprediction was repaired at write result (early branch resolution)
+	bool fused;		// ADDI/SUBI fused with the conditional branch that follows it (macro-op fusion)
+	unsigned branch_target;	// fused: pc the branch continues at (the value field holds the ALU result)
 	bool store_committed;	// used since store takes >1cc in commit
-	unsigned store_exit_cc;
-	unsigned store_mem_unit_index;
+	unsigned store_exit_cc;	// last clock cycle of the memory write of a committing store
+	unsigned store_mem_unit_index;	// memory unit performing that write
+	unsigned store_address;	// stores: address, as soon as the base register is available (UNDEFINED before)
+	unsigned load_address;	// loads (memory speculation): address, once the load executed (UNDEFINED before)
+	unsigned load_source;	// loads (memory speculation): store that forwarded the value (UNDEFINED: memory)
+	unsigned load_dependence; // loads: store the store-set predictor made the load wait for (UNDEFINED: none)
+	bool load_held;		// loads: waited for load_dependence
+	bool load_violated;	// loads: read a stale value (squashed when it reaches the head of the ROB)
 }rob_entry_t;
 
 // reservation station entry
@@ -87,11 +125,22 @@ typedef struct{
 	unsigned tag2;	    // Qk field
 	unsigned destination; // destination field
 	unsigned address;     // address field (for loads and stores)
-	bool received_tag_this_cycle;
-    bool instr_exed_this_cycle;
-	bool instr_has_been_exed;
+	unsigned result;      // result, written to the ROB in the write result stage
+	unsigned wr_cycle;    // clock cycle of the write result (UNDEFINED: the instruction has not started executing)
+	unsigned released;    // clock cycle in which the station was freed (it can be reused from the next one)
 }res_station_entry_t;
 
+// dynamic instruction produced by the functional model (functional-first simulation)
+typedef struct{
+	unsigned pc;		// address of the instruction
+	opcode_t opcode;	// opcode
+	unsigned value1;	// first source operand (data register for stores)
+	unsigned value2;	// second source operand (immediate for ADDI/SUBI, base register for stores)
+	unsigned address;	// effective address (loads and stores)
+	unsigned result;	// value written to the destination/memory (next pc for branches)
+	bool taken;		// branch outcome
+} dyn_instr_t;
+
 //instruction window 
 typedef struct{
 	unsigned num_entries;
@@ -110,6 +159,8 @@ typedef struct{
 	res_station_entry_t *entries;
 }res_stations_t;
 
+class sim_func;
+
 class sim_ooo{
 
 	/* Add the data members required by your simulator's implementation here */
@@ -119,6 +170,9 @@ class sim_ooo{
 
 	//issue width
 	unsigned issue_width;
+
+	//commit (retire) width
+	unsigned commit_width;
 	
 	//instruction window
 	instr_window_t pending_instructions;
@@ -130,20 +184,23 @@ class sim_ooo{
 	res_stations_t reservation_stations;
 
 	//execution units
-        unit_t exec_units[MAX_UNITS];
+        unit_t exec_units[MAX_UNIT_ENTRIES];
         unsigned num_units;
 
+	// true if the unit can start an operation in this clock cycle (a pipelined unit takes one per initiation interval)
+	bool unit_accepts(unsigned unit);
+
 	//instruction memory
 	instruction_t instr_memory[PROGRAM_SIZE];
 
         //base address in the instruction memory where the program is loaded
         unsigned instr_base_address;
 
-	//data memory - should be initialize to all 0xFF
-	unsigned char *data_memory;
+	//data memory - should be initialize to all 0xFF (sparse: pages are allocated on first write)
+	sim_memory *data_memory;
 
-	//memory size in bytes
-	unsigned data_memory_size;
+	//false if the data memory belongs to someone else (e.g., shared by the cores of a sim_multicore)
+	bool owns_data_memory;
 	
 	//instruction executed
 	unsigned instructions_executed;
@@ -159,39 +216,316 @@ class sim_ooo{
 	
 	// pc, register arrays
 	unsigned pc; // address based
-	unsigned real_pc; // index based
-
-	float int_fp_registers[NUM_GP_REGISTERS * 2];
-	//unsigned int_registers[NUM_GP_REGISTERS];
-	//float fp_registers[NUM_GP_REGISTERS];
-
-	// null inst
-	instruction_t null_inst;
 
-	instruction_t IReg; // doesn't need to be in an array bc of reservations? + more than one instruction per stage
+	unsigned int_registers[NUM_GP_REGISTERS];
+	float fp_registers[NUM_GP_REGISTERS];
 
+	// the ROB entry doubles as the tag of the instruction: the instruction window entry and the
+	// reservation station of a dynamic instruction refer to it, never to the static instruction
 	unsigned ROB_headptr; // holds index of top of ROB - ++ after each successful commit, if equal to rob size rolls back to 0
-	unsigned PI_headptr; // holds index of top of pending index board - ++ after each instruction issue (value is stored per instruction)
-	unsigned ROB_nextindex;
-	unsigned last_instruction_pc;
+	unsigned ROB_nextindex; // first free entry of the ROB (where the next instruction is issued)
+
+	// rename map: ROB entry of the latest issued writer of each register slot (R0-R31, then F0-F31; UNDEFINED:
+	// the value is in the register file); a retiring writer leaves it, and a squash rebuilds it from the ROB
+	unsigned rename_map[NUM_GP_REGISTERS * 2];
+
+	// issue group: the instructions decoded in a clock cycle, then renamed and allocated together
+	typedef struct{
+		unsigned pc;
+		bool fused;
+		unsigned station;		// reservation station taken
+		unsigned sources[2];		// register slots read, in value1/value2 order (UNDEFINED: none)
+		unsigned producers[2];		// ROB entry producing each source (UNDEFINED: register file)
+		unsigned destination;		// register slot written (UNDEFINED: none)
+		unsigned next_pc;		// pc issued after it (predicted target for branches)
+		unsigned long long history;	// branches: global history the direction was predicted with
+	} issue_slot_t;
+	vector<issue_slot_t> issue_group;	// issue_width slots
 
 	bool finished;
 
-	unsigned data_mem_latency;
+	// stall counters (cycles in which issue stopped early)
+	unsigned rob_full_stalls; // no free ROB/instruction window entry
+	unsigned rs_full_stalls;  // no free reservation station of the required type
+
+	// load/store queue: the stores in the ROB whose address is known are indexed by the 4-byte words
+	// they write, so a load only searches the stores that can alias it
+	multimap<unsigned, unsigned> lsq_index;	// word (address >> 2) -> ROB entry of the store
+	unsigned lsq_unresolved;		// stores in the ROB whose address is not known yet
+	unsigned store_forwarding_latency;	// cycles from EXE to WR of a load forwarded by an older store
+	unsigned forwarded_loads;
+	unsigned disambiguation_stalls;		// cycles in which a ready load waited for an older store
+
+	// branch prediction at issue (no predictor: the issue always continues at pc + 4)
+	sim_bpred *bpred;
+	branch_predictor_t bpred_type;
+	unsigned bpred_entries;
+	unsigned bpred_history_bits;
+	sim_btb btb;
+	unsigned branches;			// committed branches (conditional and JUMP)
+	unsigned branch_mispredictions;
+	unsigned btb_misses;			// branches predicted taken whose target was not in the BTB
+
+	// returns the pc fetched after the branch at branch_pc; *history is set to the global history the direction
+	// was predicted with
+	unsigned predict_branch(unsigned branch_pc, opcode_t opcode, unsigned long long *history);
+
+	// early branch resolution: a mispredicted branch squashes the younger instructions when it writes its
+	// result, and the issue restarts at its next pc "redirect_penalty" clock cycles later
+	bool early_branch_resolution;
+	unsigned redirect_penalty;
+	unsigned redirect_cycle;		// first clock cycle in which the issue can restart after a redirect
+	unsigned early_redirects;
+	unsigned redirect_stalls;		// cycles in which the issue waited for a redirect
+
+	// squashes the instructions younger than the mispredicted branch in ROB entry rob_index and redirects the issue
+	void redirect_branch(unsigned rob_index);
+
+	// decoupled front end (disabled if fetch_width is 0: the issue reads the instruction memory at pc)
+	typedef struct{
+		unsigned pc;
+		unsigned ready;			// clock cycle from which the instruction can issue (decoded)
+		unsigned next_pc;		// pc fetched after it (predicted target for branches)
+		unsigned long long history;	// branches: global history the direction was predicted with
+	} fetch_entry_t;
+	deque<fetch_entry_t> fetch_queue;
+	unsigned fetch_width;
+	unsigned fetch_queue_size;
+	unsigned taken_branch_bubbles;
+	unsigned decode_latency;
+	unsigned fetch_pc;			// next pc to fetch (UNDEFINED: continue at pc)
+	unsigned fetch_restart;			// first clock cycle in which fetch continues after a taken branch
+	unsigned frontend_stalls;		// cycles in which the issue found no decoded instruction
+	unsigned fetch_bubbles;			// fetch cycles lost to taken branches
+	unsigned fetched_instructions;
+
+	// loop buffer (disabled if loop_buffer_size is 0): holds the decoded body [loop_start, loop_end] of the last
+	// loop whose back-edge was predicted taken twice in a row (loop_end = UNDEFINED: empty)
+	unsigned loop_buffer_size;
+	unsigned loop_branch_pc;		// last backward branch predicted taken
+	unsigned loop_start;
+	unsigned loop_end;
+	unsigned loop_buffer_fetches;
+
+	// captures the loop closed by the fetched branch if its back-edge repeats; returns true if it did
+	bool loop_buffer_capture(const fetch_entry_t &fetched);
+
+	// macro-op fusion: an ADDI/SUBI and the conditional branch on its result issue as a single ROB entry
+	bool macro_op_fusion;
+	unsigned fused_pairs;
+
+	// returns true if the instruction at pc can issue fused with the branch that follows it
+	// (with a front end, the instruction is fetch_queue[queue_index])
+	bool can_fuse(unsigned pc, unsigned queue_index=0);
+
+	// returns the branch fused into ROB entry rob_index
+	instruction_t &fused_branch(unsigned rob_index);
+
+	// logs the instruction in ROB entry rob_index (a fused pair takes two lines)
+	void log_instruction(unsigned rob_index);
+
+	// fetches up to fetch_width instructions into the fetch queue (end of the clock cycle)
+	void fetch();
+
+	// drops the fetched instructions and restarts fetch at pc (after a flush, a redirect or a squash)
+	void flush_front_end();
+
+	// post-commit store buffer (disabled if store_buffer_size is 0: a store keeps the head of the ROB until
+	// its memory write completes); committed stores update the memory at once, the buffer only holds the
+	// lines still to be written, in commit order, with the bytes written by the stores combined into them
+	typedef struct{
+		unsigned line;			// line address
+		unsigned long long mask;	// bytes of the line written by the buffered stores (bit i = byte i)
+		unsigned unit;			// memory unit writing the line (UNDEFINED while waiting)
+		unsigned done;			// clock cycle in which the write completes
+	} store_buffer_entry_t;
+	typedef enum {SB_MISS, SB_HIT, SB_PARTIAL} store_buffer_lookup_t;
+	deque<store_buffer_entry_t> store_buffer;
+	unsigned store_buffer_size;
+	unsigned store_buffer_line;
+	unsigned store_commit_stalls;		// cycles in which the store at the head of the ROB could not leave it
+	unsigned combined_stores;		// stores merged into a line already waiting in the buffer
+
+	// adds the store committing from ROB entry rob_index to the store buffer; returns false if it is full
+	bool store_buffer_insert(unsigned rob_index);
+
+	// bytes of the load of "address" found in the store buffer (SB_PARTIAL: the load waits for the drain)
+	store_buffer_lookup_t store_buffer_lookup(unsigned address);
+
+	// writes the waiting lines through the free memory units, and removes the written ones
+	void store_buffer_drain();
+
+	// load/store ports and address-interleaved banks of the data memory (disabled if load_ports is 0: every
+	// MEMORY unit is an independent port); in each clock cycle at most load_ports loads and store_ports
+	// stores start an access, and each bank serves one of them
+	unsigned load_ports;
+	unsigned store_ports;
+	unsigned num_banks;
+	unsigned bank_interleave;
+	vector<unsigned> bank_cycle;		// last clock cycle in which each bank started an access
+	unsigned loads_this_cycle;
+	unsigned stores_this_cycle;
+	unsigned load_port_accesses;
+	unsigned store_port_accesses;
+	unsigned port_stalls;			// accesses delayed by a clock cycle because no port was free
+	unsigned bank_conflicts;		// accesses delayed by a clock cycle because their bank was in use
+
+	// reserves a port and the bank of "address" (UNDEFINED: forwarded load, no bank) for an access starting
+	// in this clock cycle; returns false if the access has to retry in the next one
+	bool memory_port_reserve(bool write, unsigned address);
+
+	// memory speculation (enabled by configuring the store-set predictor): loads execute before the addresses
+	// of older stores are known, unless the predictor expects a conflict; the executed loads are indexed like
+	// the stores, so a store resolving its address finds the younger loads that read a stale value
+	sim_storeset store_sets;
+	multimap<unsigned, unsigned> lsq_load_index;	// word (address >> 2) -> ROB entry of the executed load
+	unsigned memory_violations;
+	unsigned false_dependences;
+
+	// execution units that started an operation in the last simulated clock cycle (bit i = exec_units[i])
+	unsigned dispatched_units;
+
+	// common data buses (num_cdbs = 0: every result due in a clock cycle is written in it)
+	unsigned num_cdbs;
+	cdb_arbitration_t cdb_arbitration;
+	unsigned cdb_broadcasts;
+	unsigned cdb_conflicts;			// results held for a clock cycle because no bus was free
+	vector< pair<unsigned, unsigned> > cdb_requests;	// (priority, reservation station) of the results due
+
+	// grants the buses to up to num_cdbs of the results due in this clock cycle: the others are held, with
+	// their unit, until the next one
+	void cdb_arbitrate();
+
+	// functional-first simulation: the functional model runs ahead on its own thread and
+	// the timing model takes values, addresses and branch outcomes from its dynamic instructions
+	bool functional_first;
+	unsigned oracle_queue_size;
+	sim_func *oracle;		// functional model (created by run())
+	dyn_instr_t oracle_next;	// next dynamic instruction not bound to a ROB entry yet
+	bool oracle_has_next;
+	bool on_correct_path;		// false while issuing past a taken branch (until the flush)
+	dyn_instr_t *rob_oracle;	// dynamic instruction bound to each ROB entry
+	dyn_instr_t *rob_oracle_branch;	// fused entries: dynamic instruction of the branch
+	bool *rob_oracle_valid;
+	deque<dyn_instr_t> oracle_replay;	// dynamic instructions squashed by a memory order violation (issued again first)
+
+	// binds the next dynamic instruction to the ROB entry being issued (if it matches its pc)
+	void bind_oracle(unsigned rob_index);
+
+	// takes the next dynamic instruction into *dyn if it is the one at instr_pc; otherwise the issue left
+	// the correct path, and false is returned
+	bool oracle_take(unsigned instr_pc, dyn_instr_t *dyn);
+
+	// returns the dynamic instruction bound to ROB entry rob_index (NULL if none)
+	dyn_instr_t *oracle_instr(unsigned rob_index);
+
+	// data TLB (disabled unless configured by init_tlb)
+	sim_tlb dtlb;
+
+	// data cache hierarchy (dcache[0] = L1D; empty: fixed MEMORY unit latency)
+	vector<sim_cache> dcache;
+
+	// reuse-distance analysis of the data address stream (NULL if disabled)
+	sim_reuse *reuse;
+
+	// DRAM main memory (disabled unless configured by init_dram) and its requests in flight
+	sim_dram dram;
+	typedef struct{
+		unsigned id;
+		unsigned levels;	// cache levels that missed (filled when the data arrives)
+		bool write;
+	} dram_wait_t;
+	vector<dram_wait_t> dram_waits;
+
+	// schedules the DRAM requests of this clock cycle and times the memory accesses waiting for them
+	void dram_tick();
+
+	// cycles memory unit "unit" is busy with an access to the given address, started in this clock cycle
+	// (TLB, then the cache hierarchy; with caches, the unit latency is only paid after a miss in the last level)
+	// "unit_bound" is set to false if the time does not depend on the unit latency (cache hit, DRAM access)
+	// an access sent to the DRAM returns DRAM_PENDING: dram_tick() sets the actual time once it is scheduled
+	unsigned memory_access_latency(unsigned unit, unsigned address, bool write, bool *unit_bound);
+
+	// pipeline stages, called in this order in each clock cycle
+	void execute();
+	void write_result();
+	void issue();
+	void commit();
+
+	// commits the instruction at the head of the ROB; returns true if it retired (the next one may follow)
+	bool commit_head();
+
+	// retires the instruction at the head of the ROB (for a store, once its memory write completed)
+	void retire_head();
+
+	// sets "finished" once the issue reached EOP and the ROB is empty
+	void check_finished();
+
+	// returns the instruction in ROB entry rob_index
+	instruction_t &rob_instruction(unsigned rob_index);
+
+	// decodes the issue group into issue_group; returns the number of instructions that can issue
+	unsigned decode_group();
+
+	// reads a source register slot at issue, renamed to "producer": *value is set if the register is available
+	// (register file, or ROB entry already written), *tag to the ROB entry that will produce it otherwise
+	void read_operand(unsigned slot, unsigned producer, unsigned *value, unsigned *tag);
+
+	// adds to the load/store queue the store issued in ROB entry rob_index / records its address / removes it
+	void lsq_insert(unsigned rob_index);
+	void lsq_resolve(unsigned rob_index, unsigned address);
+	void lsq_remove(unsigned rob_index);
+
+	// memory speculation: records the address of the load executing in ROB entry rob_index (source: store
+	// forwarding the value, UNDEFINED if it reads the memory) / removes it
+	void lsq_execute_load(unsigned rob_index, unsigned address, unsigned source);
+	void lsq_remove_load(unsigned rob_index);
+
+	// flags the oldest load younger than the store in ROB entry rob_index that read a stale value from
+	// the bytes the store writes, and trains the store-set predictor
+	void lsq_check_violations(unsigned rob_index);
+
+	// squashes the violated load at the head of the ROB and everything after it, and refetches from the load
+	void memory_order_squash();
+
+	// checks the older stores before the load in ROB entry rob_index reads "address"; returns false if the load must wait
+	// (with memory speculation, the load only waits for an older store with an unknown address if it is predicted to conflict)
+	// (*store: older store forwarding the value, UNDEFINED if the load reads the memory)
+	bool load_disambiguate(unsigned rob_index, unsigned address, unsigned *store);
+
+	// occupies/frees an execution unit
+	// (unit_bound: the time depends on the unit latency, so set_unit_latency can retime the operation)
+	void occupy_unit(unsigned unit, unsigned rob_index, unsigned cycles, bool unit_bound=true);
+	void release_unit(unsigned unit);
+
+	// returns the index of the ROB entry that will write the given register (slot: R0-R31, then F0-F31)
+	unsigned rename_lookup(unsigned slot);
+
+	// rebuilds the rename map from the instructions left in the ROB
+	void rename_rebuild();
+
+	// removes the instructions younger than the one in ROB entry rob_index from the pipeline
+	void squash_younger(unsigned rob_index);
 public:
 
 	/* Instantiates the simulator
           	Note: registers must be initialized to UNDEFINED value, and data memory to all 0xFF values
         */
-	sim_ooo(unsigned mem_size, 		// size of data memory (in byte)
+	sim_ooo(unsigned mem_size, 		// size of data memory (in byte, 0 = whole 32-bit address space)
 		unsigned rob_size, 		// number of ROB entries
                 unsigned num_int_res_stations,	// number of integer reservation stations 
                 unsigned num_add_res_stations,	// number of ADD reservation stations
                 unsigned num_mul_res_stations, 	// number of MULT/DIV reservation stations
                 unsigned num_load_buffers,	// number of LOAD buffers
-		unsigned issue_width=1		// issue width
+		unsigned issue_width=1,		// issue width
+		unsigned commit_width=1		// instructions retired per cycle (0 = 1)
         );	
 	
+	//copies the complete state of another simulator (used to fork a simulation)
+	//NOTE: keep in sync with the data members above
+	//throws sim_error if the functional model of a functional-first simulation is already running
+	sim_ooo(const sim_ooo &other);
+
 	//de-allocates the simulator
 	~sim_ooo();
 
@@ -199,16 +533,140 @@ public:
         // - exec_unit: type of execution unit to be added
         // - latency: latency of the execution unit (in clock cycles)
         // - instances: number of execution units of this type to be added
-        void init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances=1);
+        // - initiation_interval: clock cycles between two operations started by a unit (1: fully pipelined;
+        //   0 or more than the latency: unpipelined, the unit is busy for its whole latency)
+        // a pipelined unit takes an entry per operation it can hold in flight, sized for this latency
+        // throws sim_error if the processor would exceed MAX_UNITS units or MAX_UNIT_ENTRIES entries
+        void init_exec_unit(exe_unit_t exec_unit, unsigned latency, unsigned instances=1, unsigned initiation_interval=0);
+
+	//replaces the data memory with an external one, shared with other simulators
+	//the memory is neither de-allocated nor cleared (by reset) by this simulator
+	void attach_data_memory(sim_memory *memory);
+
+	//changes the latency of all execution units of the given type
+	//the operations they started in the last simulated clock cycle are retimed to the new latency (this requires
+	//the previous latency to be at least 2 clock cycles); older operations in flight are not affected
+	//(with a data cache hierarchy, the arrival time of the lines already requested is not retimed)
+	void set_unit_latency(exe_unit_t exec_unit, unsigned latency);
+
+	//returns the execution unit types present in the processor (bit t = exe_unit_t t)
+	unsigned get_unit_types();
+
+	//returns the execution unit types that started an operation in the last simulated clock cycle (bit t = exe_unit_t t)
+	unsigned get_dispatched_unit_types();
 
 	//related to functional unit
+	//returns UNDEFINED if no unit is currently available, throws sim_error if the configuration cannot execute the opcode
 	unsigned get_free_unit(opcode_t opcode);
 
 	//loads the assembly program in file "filename" in instruction memory at the specified address
+	//throws sim_error if the file cannot be parsed; the previously loaded program is then left untouched
 	void load_program(const char *filename, unsigned base_address=0x0);
 
+	//loads an already decoded program (see parse_program) in instruction memory at the specified address
+	void load_program(const instruction_t *program, unsigned base_address=0x0);
+
 	//runs the simulator for "cycles" clock cycles (run the program to completion if cycles=0) 
 	void run(unsigned cycles=0);
+
+	//enables/disables functional-first simulation, effective from the next call to run()
+	//the functional model starts from the architectural state at that point and streams
+	//its dynamic instructions through a queue of "queue_size" entries
+	//the timing (and therefore the output) is the same as without functional-first simulation
+	void set_functional_first(bool enable, unsigned queue_size=4096);
+
+	//sets the latency of a load that takes its value from an older store in the load/store queue (default: 1)
+	//throws sim_error if the latency is 0
+	void set_store_forwarding_latency(unsigned latency);
+
+	//adds a post-commit store buffer of "entries" lines of line_size bytes (0 entries: no store buffer, the default)
+	//a store leaves the ROB once its line is in the buffer (a store to a line still waiting is combined into it)
+	//and commit stalls only while the buffer is full; the lines are written by the memory units loads leave
+	//idle, and loads reading bytes held by the buffer are forwarded (or wait for the drain if only some are)
+	//throws sim_error if line_size is not a power of 2 between 4 and 64
+	void set_store_buffer(unsigned entries, unsigned line_size=64);
+
+	//puts load/store ports and "banks" banks, interleaved every "interleave" bytes, in front of the data memory:
+	//in each clock cycle at most load_ports loads (forwarded ones included) and store_ports stores (committing or
+	//draining from the store buffer) start an access, one per bank; the others retry in the next clock cycle
+	//(the MEMORY units still set the occupancy and latency of each access; 0 load ports: no port model, the default)
+	//throws sim_error if store_ports or banks is 0, or if interleave is not a power of 2
+	void set_memory_ports(unsigned load_ports, unsigned store_ports, unsigned banks=1, unsigned interleave=8);
+
+	//limits the results written (and broadcast) per clock cycle to num_cdbs common data buses (0: unlimited, the
+	//default); when more are due, the buses go to the oldest instructions (OLDEST_FIRST) or to the units added
+	//first (UNIT_ORDER, forwarded loads last), and the others hold their result and their unit for a clock cycle
+	//(stores write no result, so they do not use a bus)
+	void set_cdbs(unsigned num_cdbs, cdb_arbitration_t arbitration=OLDEST_FIRST);
+
+	//predicts the branches at issue with a direction predictor of the given type (see sim_bpred::create) and a BTB
+	//of btb_entries targets: the issue continues at the predicted pc (a taken prediction ends the issue group, and
+	//one that misses in the BTB falls through), and the ROB is flushed only when a branch commits with a next pc
+	//different from the predicted one. JUMP is predicted taken. Without predictor (default), every taken branch
+	//flushes the ROB
+	//throws sim_error on an invalid configuration
+	void init_branch_predictor(branch_predictor_t type, unsigned entries=4096, unsigned history_bits=12,
+				   unsigned btb_entries=512, unsigned btb_associativity=4);
+
+	//enables/disables early branch resolution: a mispredicted branch (a taken branch without predictor) squashes
+	//the younger instructions when it writes its result, instead of when it commits, and the issue restarts at its
+	//next pc "penalty" clock cycles later; the branch then commits normally (disabled by default)
+	void set_early_branch_resolution(bool enable, unsigned penalty=1);
+
+	//adds a fetch stage in front of the issue: every clock cycle it fetches up to fetch_width instructions into
+	//a queue of queue_size entries, from which they can issue decode_latency clock cycles later. Branches are
+	//predicted at fetch; a taken prediction ends the fetch group and fetch then idles for taken_branch_bubbles
+	//clock cycles. Throws sim_error if fetch_width, queue_size or decode_latency is 0
+	void init_front_end(unsigned fetch_width, unsigned queue_size=16, unsigned taken_branch_bubbles=1, unsigned decode_latency=1);
+
+	//adds a loop buffer of "entries" instructions to the front end (needs init_front_end and a branch predictor):
+	//once a backward branch is predicted taken twice in a row and its body fits, the body is captured, and fetch
+	//supplies it from the buffer, already decoded (issuable the next clock cycle), without taken-branch bubbles
+	//and BTB lookups (branches are still predicted). 0 disables it (default)
+	void set_loop_buffer(unsigned entries);
+
+	//enables/disables macro-op fusion: an ADDI/SUBI immediately followed by a conditional branch on its destination
+	//register issues as one operation, taking one issue slot, one ROB entry and one INTEGER reservation station.
+	//The INTEGER unit computes the result and evaluates the branch on it; commit writes the register and resolves
+	//the branch, and the pair counts as two instructions. It applies in every mode (with or without branch
+	//predictor, front end, early branch resolution or functional-first simulation); with a front end, both
+	//instructions must be decoded (disabled by default)
+	void set_macro_op_fusion(bool enable);
+
+	//enables memory speculation: loads execute before the addresses of older stores are known, except the loads
+	//that the store-set predictor (SSIT/LFST tables of the given size) expects to conflict with an older store
+	//a load that read a stale value is squashed with everything after it, and refetched, once it reaches the
+	//head of the ROB (without memory speculation, loads wait until the addresses of all older stores are known)
+	//throws sim_error if a table is empty
+	void enable_memory_speculation(unsigned ssit_entries=1024, unsigned lfst_entries=128);
+
+	//configures a data TLB consulted by every load/store when the memory unit starts the access
+	//(use page_size >= 2MB for huge pages); a miss adds a page walk of "walk_level_latency" cycles
+	//per page table level to the access
+	//throws sim_error on an invalid configuration (see sim_tlb::init)
+	void init_tlb(unsigned entries, unsigned associativity, unsigned page_size=4096, unsigned walk_level_latency=20);
+
+	//adds a level to the data cache hierarchy (first call: L1D, second call: L2, ...); mshrs=0 makes it blocking
+	//with a hierarchy, the memory unit is busy for the latency of the level the access hits in, and
+	//the latency of the MEMORY units becomes the main memory latency, paid after a miss in the last level
+	//throws sim_error on an invalid geometry (see sim_cache)
+	void add_cache_level(unsigned size, unsigned associativity, unsigned line_size, unsigned hit_latency,
+			     replacement_t policy=LRU, unsigned mshrs=0);
+
+	//enables the reuse-distance analysis of the data addresses accessed by the memory unit, which
+	//yields the miss ratio of every LRU cache up to max_sets sets and max_associativity ways in one run
+	//throws sim_error if a parameter is not a power of 2
+	void enable_reuse_analysis(unsigned line_size=64, unsigned max_sets=1024, unsigned max_associativity=16);
+
+	//attaches a DRAM main memory model: accesses that miss in every cache level (all accesses without
+	//caches) keep the memory unit busy until the DRAM returns the line, instead of the MEMORY unit latency
+	//throws sim_error on an invalid configuration (see sim_dram::init)
+	void init_dram(unsigned channels, unsigned banks, unsigned row_size=2048, row_policy_t policy=OPEN_PAGE,
+		       unsigned tRCD=14, unsigned tCAS=14, unsigned tRP=14, unsigned burst=4,
+		       unsigned line_size=64, unsigned queue_size=32);
+
+	//returns the reuse-distance analysis of the current run (NULL if not enabled)
+	sim_reuse *get_reuse_analysis();
 	
 	//resets the state of the simulator
         /* Note: 
@@ -245,26 +703,121 @@ public:
 	//returns the number of clock cycles 
 	unsigned get_clock_cycles();
 
+	//returns the number of cycles in which issue stalled because the ROB was full
+	unsigned get_rob_stalls();
+
+	//returns the number of cycles in which issue stalled because no reservation station was free
+	unsigned get_rs_stalls();
+
+	//returns the number of loads forwarded by an older store, and the number of cycles in which ready loads
+	//waited for an older store (unknown address, value not written yet, or partial overlap)
+	unsigned get_forwarded_loads();
+	unsigned get_disambiguation_stalls();
+
+	//returns the number of cycles in which the store at the head of the ROB could not leave it (memory write in
+	//progress, no free memory unit, or store buffer full), and the number of stores combined in the store buffer
+	unsigned get_store_commit_stalls();
+	unsigned get_combined_stores();
+
+	//returns the number of memory accesses delayed because no port was free / because their bank was in use, and
+	//the fraction of the load/store port slots used in the current run
+	unsigned get_port_stalls();
+	unsigned get_bank_conflicts();
+	double get_load_port_utilization();
+	double get_store_port_utilization();
+
+	//returns the number of times a result due was held for a clock cycle because no common data bus was free
+	//(writeback conflicts), and the fraction of the bus slots used in the current run
+	unsigned get_cdb_conflicts();
+	double get_cdb_utilization();
+
+	//returns the number of memory order violations (loads squashed because an older store wrote their data), and
+	//the number of loads the store-set predictor made wait for an older store to another address (false dependences)
+	unsigned get_memory_order_violations();
+	unsigned get_false_dependences();
+
+	//returns the number of committed branches and of mispredicted ones, the prediction accuracy, the
+	//mispredictions per 1000 instructions and the number of taken predictions that missed in the BTB
+	unsigned get_branches();
+	unsigned get_branch_mispredictions();
+	double get_branch_accuracy();
+	double get_branch_mpki();
+	unsigned get_btb_misses();
+
+	//returns the number of mispredicted branches resolved at write result, and the number of clock cycles in which
+	//the issue waited for the redirect penalty
+	unsigned get_early_redirects();
+	unsigned get_redirect_stalls();
+
+	//returns the number of clock cycles in which the issue found no decoded instruction in the fetch queue
+	//(front-end stalls), and the number of fetch cycles lost to taken branches
+	unsigned get_frontend_stalls();
+	unsigned get_fetch_bubbles();
+
+	//returns the number of instructions supplied by the loop buffer, and their fraction of the fetched instructions
+	unsigned get_loop_buffer_fetches();
+	double get_loop_buffer_coverage();
+
+	//returns the number of committed fused pairs, and the fraction of the committed instructions they contain
+	unsigned get_fused_pairs();
+	double get_fusion_rate();
+
+	//returns the number of data TLB lookups/misses in the current run
+	unsigned get_tlb_accesses();
+	unsigned get_tlb_misses();
+
+	//returns the DRAM row-buffer hit rate and average bandwidth (bytes per cycle) in the current run
+	double get_dram_row_hit_rate();
+	double get_dram_bandwidth();
+
+	//returns the number of hits/misses in the given data cache level (0 = L1D) in the current run
+	unsigned get_cache_hits(unsigned level);
+	unsigned get_cache_misses(unsigned level);
+
+	//returns true once the program has run to completion
+	bool is_finished();
+
 	//prints the content of the data memory within the specified address range
-	void print_memory(unsigned start_address, unsigned end_address);
+	void print_memory(unsigned start_address, unsigned end_address, ostream &out=cout);
+
+	//prints the configuration and statistics of the data TLB, of each data cache level, of the DRAM and of the memory ports
+	void print_cache_stats(ostream &out=cout);
 
 	// writes an integer value to data memory at the specified address (use little-endian format: https://en.wikipedia.org/wiki/Endianness)
 	void write_memory(unsigned address, unsigned value);
 
+	//copies "size" bytes from "data" to data memory starting at the specified address (memcpy semantics)
+	//throws sim_error if the range is outside of data memory
+	void write_memory_block(unsigned address, const void *data, unsigned size);
+
+	//copies "size" bytes of data memory starting at the specified address to "data" (memcpy semantics)
+	//throws sim_error if the range is outside of data memory
+	void read_memory_block(unsigned address, void *data, unsigned size);
+
+	//maps the binary file "filename" (raw little-endian data) copy-on-write into data memory at the given address
+	//throws sim_error if the file cannot be mapped or does not fit in data memory
+	void load_memory_image(const char *filename, unsigned base_address);
+
+	//writes the content of the data memory within the specified address range to the binary file "filename"
+	void dump_memory_image(const char *filename, unsigned start_address, unsigned end_address);
+
+	//prints the branch prediction and front-end statistics
+	void print_branch_stats(ostream &out=cout);
+
 	//prints the values of the registers 
-	void print_registers();
+	void print_registers(ostream &out=cout);
 
 	//prints the status of processor excluding memory
-	void print_status();
+	void print_status(ostream &out=cout);
 
 	// prints the content of the ROB
-	void print_rob();
+	void print_rob(ostream &out=cout);
 
 	//prints the content of the reservation stations
-	void print_reservation_stations();
+	void print_reservation_stations(ostream &out=cout);
 
 	//print the content of the instruction window
-	void print_pending_instructions();
+	void print_pending_instructions(ostream &out=cout);
 
 	//initialize the execution log
 	void init_log();
@@ -273,7 +826,7 @@ public:
 	void commit_to_log(instr_window_entry_t iwe);
 
 	//print log
-	void print_log();
+	void print_log(ostream &out=cout);
 
 	// reset instruction
 	void reset_pending_instruction(unsigned index);
@@ -281,13 +834,19 @@ public:
 	// reset RS
 	void reset_reservation_station(unsigned i);
 
-	// check opcode
-	bool isALUorSTORE(instruction_t i);
+};
 
-	bool isBRANCH(instruction_t i);
+//helpers shared by the timing and the functional model
+unsigned alu(opcode_t opcode, unsigned value1, unsigned value2, unsigned immediate, unsigned pc);
+bool is_branch(opcode_t opcode);
+bool is_memory(opcode_t opcode);
 
-	//void write_rob(unsigned target_pc, unsigned result);
+//true if value is a non-zero power of 2 (used to validate TLB and memory hierarchy geometries)
+bool is_power_of_2(unsigned value);
 
-};
+//parses the assembly program in file "filename" into "program" (PROGRAM_SIZE entries)
+//the result can be shared by several simulators through sim_ooo::load_program
+//throws sim_error if the file cannot be opened, contains an invalid opcode or exceeds PROGRAM_SIZE instructions
+void parse_program(const char *filename, instruction_t *program);
 
 #endif /*SIM_OOO_H_*/
@@ -0,0 +1,142 @@
+#include "sim_reuse.h"
+#include "sim_ooo.h"
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+/* =============================================================
+
+   LRU stack distances
+
+   ============================================================= */
+
+reuse_stack::reuse_stack(){
+	time = 0;
+}
+
+void reuse_stack::add(unsigned t, int delta){
+	for (; t < tree.size(); t += t & (-t)) tree[t] += delta;
+}
+
+unsigned reuse_stack::prefix(unsigned t){
+	unsigned sum = 0;
+	for (; t > 0; t -= t & (-t)) sum += tree[t];
+	return sum;
+}
+
+void reuse_stack::compact(){
+	// renumber the marked times 1..n keeping their order, then rebuild the tree with room to grow
+	vector<pair<unsigned, unsigned> > order; // (time, line)
+	order.reserve(last.size());
+	for (unordered_map<unsigned, unsigned>::iterator it = last.begin(); it != last.end(); ++it)
+		order.push_back(make_pair(it->second, it->first));
+	sort(order.begin(), order.end());
+	unsigned capacity = 2 * order.size() < 64 ? 64 : 2 * order.size();
+	tree.assign(capacity + 1, 0);
+	for (unsigned i=0; i<order.size(); i++){
+		last[order[i].second] = i + 1;
+		add(i + 1, 1);
+	}
+	time = order.size();
+}
+
+unsigned reuse_stack::access(unsigned line){
+	if (time + 1 >= tree.size()) compact();
+	time++;
+	unsigned distance = UNDEFINED;
+	unordered_map<unsigned, unsigned>::iterator it = last.find(line);
+	if (it != last.end()){
+		distance = prefix(time - 1) - prefix(it->second);
+		add(it->second, -1);
+		it->second = time;
+	} else last[line] = time;
+	add(time, 1);
+	return distance;
+}
+
+/* =============================================================
+
+   Miss ratio curves
+
+   ============================================================= */
+
+sim_reuse::sim_reuse(unsigned line_size, unsigned max_sets, unsigned max_associativity){
+	if (!is_power_of_2(line_size) || !is_power_of_2(max_sets) || !is_power_of_2(max_associativity))
+		throw sim_error("reuse analysis parameters must be powers of 2!");
+	this->line_size = line_size;
+	this->max_sets = max_sets;
+	this->max_associativity = max_associativity;
+	clear();
+}
+
+void sim_reuse::access(unsigned address){
+	unsigned line = address / line_size;
+	accesses++;
+	for (unsigned k=0; k<stacks.size(); k++){
+		unsigned distance = stacks[k][line & ((1u << k) - 1)].access(line);
+		if (k == 0){
+			if (distance == UNDEFINED){
+				cold_misses++;
+				continue;
+			}
+			if (distance >= full_histogram.size()) full_histogram.resize(distance + 1, 0);
+			full_histogram[distance]++;
+		}
+		if (distance < max_associativity) histograms[k][distance]++;
+	}
+}
+
+double sim_reuse::miss_ratio(unsigned sets, unsigned associativity){
+	if (!is_power_of_2(sets) || sets > max_sets || associativity == 0 || associativity > max_associativity)
+		throw sim_error("cache configuration outside of the analyzed range!");
+	if (accesses == 0) return 0;
+	unsigned k = 0;
+	while ((1u << k) < sets) k++;
+	unsigned long long hits = 0;
+	for (unsigned d=0; d<associativity; d++) hits += histograms[k][d];
+	return (double)(accesses - hits) / accesses;
+}
+
+double sim_reuse::miss_ratio_fully_associative(unsigned lines){
+	if (accesses == 0) return 0;
+	unsigned long long hits = 0;
+	for (unsigned d=0; d<lines && d<full_histogram.size(); d++) hits += full_histogram[d];
+	return (double)(accesses - hits) / accesses;
+}
+
+unsigned long long sim_reuse::get_accesses(){return accesses;}
+
+void sim_reuse::clear(){
+	stacks.clear();
+	histograms.clear();
+	for (unsigned sets=1; sets<=max_sets; sets*=2){
+		stacks.push_back(vector<reuse_stack>(sets));
+		histograms.push_back(vector<unsigned long long>(max_associativity, 0));
+	}
+	full_histogram.clear();
+	accesses = 0;
+	cold_misses = 0;
+}
+
+void sim_reuse::print_curves(ostream &out){
+	ios::fmtflags flags = out.flags();
+	streamsize precision = out.precision();
+	out << "MISS RATIO CURVES (" << dec << line_size << "B lines, " << accesses << " accesses, "
+	    << cold_misses << " cold misses)" << endl;
+	out << setfill(' ') << setw(10) << "size";
+	for (unsigned a=1; a<=max_associativity; a*=2) out << setw(9) << a << "-way";
+	out << setw(13) << "full" << endl;
+	out << fixed << setprecision(2);
+	for (unsigned long long size=line_size; size<=(unsigned long long)line_size*max_sets*max_associativity; size*=2){
+		out << setw(9) << size << "B";
+		for (unsigned a=1; a<=max_associativity; a*=2){
+			unsigned long long sets = size / ((unsigned long long)line_size * a);
+			if (sets == 0 || sets > max_sets) out << setw(13) << "-";
+			else out << setw(12) << 100.0 * miss_ratio(sets, a) << "%";
+		}
+		out << setw(12) << 100.0 * miss_ratio_fully_associative(size / line_size) << "%" << endl;
+	}
+	out.flags(flags);
+	out.precision(precision);
+}
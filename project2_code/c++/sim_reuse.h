@@ -0,0 +1,82 @@
+#ifndef SIM_REUSE_H_
+#define SIM_REUSE_H_
+
+#include <vector>
+#include <unordered_map>
+#include <iostream>
+
+using namespace std;
+
+// LRU stack distances of one access stream
+// The last access time of every line is marked in a Fenwick tree over time, so the number of
+// distinct lines touched since the previous access to a line is a range sum: O(log n) per access.
+// Times are renumbered (compacted) when the tree is full, bounding it by the number of lines.
+class reuse_stack{
+
+	unordered_map<unsigned, unsigned> last;	// line -> time of its last access (1-based)
+	vector<unsigned> tree;			// Fenwick tree over access times
+	unsigned time;
+
+	void add(unsigned t, int delta);
+	unsigned prefix(unsigned t);		// marks in [1, t]
+	void compact();
+
+public:
+
+	reuse_stack();
+
+	//returns the number of distinct lines accessed since the previous access to "line"
+	//(UNDEFINED for the first access)
+	unsigned access(unsigned line);
+};
+
+// single-pass cache analysis of a data address stream
+// For every number of sets (1, 2, 4, ..., max_sets) one LRU stack per set gives the reuse distances
+// within the set: an access misses in an A-way cache with that many sets iff its distance is >= A
+// (or it is the first access to the line). This yields the miss ratio of every cache size and
+// associativity (plus fully associative caches of any size) from one run.
+class sim_reuse{
+
+	//configuration
+	unsigned line_size;
+	unsigned max_sets;
+	unsigned max_associativity;
+
+	//stacks[k][s]: LRU stack of set s of the caches with 2^k sets
+	vector<vector<reuse_stack> > stacks;
+
+	//histograms[k][d]: accesses with distance d (< max_associativity) in the caches with 2^k sets
+	vector<vector<unsigned long long> > histograms;
+
+	//distance histogram of the fully associative cache (unbounded)
+	vector<unsigned long long> full_histogram;
+
+	unsigned long long accesses;
+	unsigned long long cold_misses;
+
+public:
+
+	//line_size, max_sets and max_associativity must be powers of 2 (throws sim_error otherwise)
+	sim_reuse(unsigned line_size=64, unsigned max_sets=1024, unsigned max_associativity=16);
+
+	//records an access to the given data address
+	void access(unsigned address);
+
+	//returns the miss ratio of an LRU cache with the given number of sets (power of 2, <= max_sets)
+	//and associativity (<= max_associativity)
+	double miss_ratio(unsigned sets, unsigned associativity);
+
+	//returns the miss ratio of a fully associative LRU cache with the given number of lines
+	double miss_ratio_fully_associative(unsigned lines);
+
+	//returns the number of accesses recorded
+	unsigned long long get_accesses();
+
+	//forgets the recorded stream
+	void clear();
+
+	//prints the miss ratio of every cache size (rows) and associativity (columns)
+	void print_curves(ostream &out=cout);
+};
+
+#endif /*SIM_REUSE_H_*/
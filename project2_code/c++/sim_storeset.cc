@@ -0,0 +1,57 @@
+#include "sim_storeset.h"
+#include "sim_ooo.h"
+
+using namespace std;
+
+sim_storeset::sim_storeset(){
+	ssit_entries = 0;
+	lfst_entries = 0;
+}
+
+void sim_storeset::init(unsigned ssit_entries, unsigned lfst_entries){
+	if (ssit_entries == 0 || lfst_entries == 0) throw sim_error("store set tables must have at least one entry!");
+	this->ssit_entries = ssit_entries;
+	this->lfst_entries = lfst_entries;
+	flush();
+}
+
+bool sim_storeset::enabled(){return ssit_entries != 0;}
+
+unsigned sim_storeset::ssit_index(unsigned pc){return (pc >> 2) % ssit_entries;}
+
+unsigned sim_storeset::load_fetched(unsigned pc){
+	if (ssit_entries == 0) return UNDEFINED;
+	unsigned set = ssit[ssit_index(pc)];
+	return set == UNDEFINED ? UNDEFINED : lfst[set];
+}
+
+void sim_storeset::store_fetched(unsigned pc, unsigned store){
+	if (ssit_entries == 0) return;
+	unsigned set = ssit[ssit_index(pc)];
+	if (set != UNDEFINED) lfst[set] = store;
+}
+
+void sim_storeset::store_resolved(unsigned pc, unsigned store){
+	if (ssit_entries == 0) return;
+	unsigned set = ssit[ssit_index(pc)];
+	if (set != UNDEFINED && lfst[set] == store) lfst[set] = UNDEFINED;
+}
+
+void sim_storeset::violation(unsigned load_pc, unsigned store_pc){
+	if (ssit_entries == 0) return;
+	unsigned &load_set = ssit[ssit_index(load_pc)];
+	unsigned &store_set = ssit[ssit_index(store_pc)];
+	if (load_set == UNDEFINED && store_set == UNDEFINED) load_set = store_set = (load_pc >> 2) % lfst_entries;
+	else if (load_set == UNDEFINED) load_set = store_set;
+	else if (store_set == UNDEFINED) store_set = load_set;
+	else load_set = store_set = (load_set < store_set ? load_set : store_set); // merge: the smaller set wins
+}
+
+void sim_storeset::clear_lfst(){
+	lfst.assign(lfst_entries, UNDEFINED);
+}
+
+void sim_storeset::flush(){
+	ssit.assign(ssit_entries, UNDEFINED);
+	lfst.assign(lfst_entries, UNDEFINED);
+}
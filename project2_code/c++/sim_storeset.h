@@ -0,0 +1,55 @@
+#ifndef SIM_STORESET_H_
+#define SIM_STORESET_H_
+
+#include <vector>
+
+using namespace std;
+
+// store-set memory dependence predictor (Chrysos & Emer)
+// The store set ID table (SSIT), indexed by instruction address, assigns loads and stores that
+// have conflicted in the past to the same store set. The last fetched store table (LFST) holds,
+// per store set, the in-flight store that was fetched last: a load of the set waits for it.
+// Store instances are identified by the caller (e.g., by their ROB entry).
+class sim_storeset{
+
+	//configuration (ssit_entries = 0: predictor disabled)
+	unsigned ssit_entries;
+	unsigned lfst_entries;
+
+	//store set of each SSIT entry (UNDEFINED: none) and last fetched store of each set (UNDEFINED: none)
+	vector<unsigned> ssit;
+	vector<unsigned> lfst;
+
+	unsigned ssit_index(unsigned pc);
+
+public:
+
+	//creates a disabled predictor
+	sim_storeset();
+
+	//configures the predictor; throws sim_error if a table is empty
+	void init(unsigned ssit_entries, unsigned lfst_entries);
+
+	//true if the predictor has been configured
+	bool enabled();
+
+	//returns the in-flight store the load at pc must wait for (UNDEFINED: none)
+	unsigned load_fetched(unsigned pc);
+
+	//records the store at pc (instance "store") as the last fetched store of its set
+	void store_fetched(unsigned pc, unsigned store);
+
+	//the address of the store at pc (instance "store") is known: later loads of its set no longer wait for it
+	void store_resolved(unsigned pc, unsigned store);
+
+	//the load at load_pc read memory before the older store at store_pc wrote it: puts both in the same set
+	void violation(unsigned load_pc, unsigned store_pc);
+
+	//forgets the stores in flight (pipeline flush)
+	void clear_lfst();
+
+	//forgets the stores in flight and the learned store sets
+	void flush();
+};
+
+#endif /*SIM_STORESET_H_*/
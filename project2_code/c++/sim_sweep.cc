@@ -0,0 +1,426 @@
+#include "sim_sweep.h"
+#include <stdlib.h>
+#include <iostream>
+#include <iomanip>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <map>
+
+using namespace std;
+
+/* =============================================================
+
+   WORK-STEALING POOL
+
+   Each worker owns a deque of design point indexes. A worker pops
+   from the back of its own deque and, once it is empty, steals from
+   the front of the others. Design points are handed out in contiguous
+   blocks, so neighbouring (similarly sized) runs stay on one worker
+   until the load becomes unbalanced.
+
+   ============================================================= */
+
+typedef struct{
+	mutex lock;
+	deque<unsigned> tasks;
+} work_queue_t;
+
+/* pops a task from the back of the worker's own queue */
+static bool pop_task(work_queue_t *queue, unsigned *task){
+	lock_guard<mutex> guard(queue->lock);
+	if (queue->tasks.empty()) return false;
+	*task = queue->tasks.back();
+	queue->tasks.pop_back();
+	return true;
+}
+
+/* steals a task from the front of another worker's queue */
+static bool steal_task(work_queue_t *queues, unsigned num_queues, unsigned self, unsigned *task){
+	for (unsigned i=1; i<num_queues; i++){
+		work_queue_t *victim = &queues[(self+i)%num_queues];
+		lock_guard<mutex> guard(victim->lock);
+		if (victim->tasks.empty()) continue;
+		*task = victim->tasks.front();
+		victim->tasks.pop_front();
+		return true;
+	}
+	return false;
+}
+
+/* collects the statistics of a simulator */
+static sim_result_t collect_result(sim_ooo *ooo, unsigned index, bool error){
+	sim_result_t result;
+	result.config = index;
+	result.instructions_executed = ooo->get_instructions_executed();
+	result.clock_cycles = ooo->get_clock_cycles();
+	result.ipc = ooo->get_IPC();
+	result.rob_stalls = ooo->get_rob_stalls();
+	result.rs_stalls = ooo->get_rs_stalls();
+	result.cdb_conflicts = ooo->get_cdb_conflicts();
+	result.finished = ooo->is_finished();
+	result.error = error;
+	return result;
+}
+
+/* result of a design point whose simulator could not be built */
+static sim_result_t error_result(unsigned index){
+	sim_result_t result;
+	memset(&result, 0, sizeof result);
+	result.config = index;
+	result.error = true;
+	return result;
+}
+
+/* =============================================================
+
+   BATCH (latency-only variants of one configuration)
+
+   ============================================================= */
+
+// simulation shared by a set of instances
+typedef struct{
+	sim_ooo *sim;
+	vector<unsigned> members;	// instances following this simulation
+	unsigned cycles;		// cycles simulated so far
+} batch_group_t;
+
+// latency programmed for the unit types on which the members of a group still disagree:
+// retiming a dispatched operation needs a previous latency of at least 2 cycles
+#define UNDECIDED_LATENCY 2
+
+/* programs the unit latencies of a group and returns the unit types on which its members disagree
+   (only the operations dispatched in the last cycle to the types whose latency changes are retimed) */
+static unsigned program_latencies(batch_group_t &group, const vector< vector<unsigned> > &latencies, unsigned types){
+	unsigned undecided = 0;
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++){
+		if (!(types & (1 << t))) continue;
+		unsigned latency = latencies[group.members[0]][t];
+		for (unsigned m=1; m<group.members.size(); m++)
+			if (latencies[group.members[m]][t] != latency){
+				undecided |= 1 << t;
+				latency = UNDECIDED_LATENCY;
+				break;
+			}
+		group.sim->set_unit_latency((exe_unit_t)t, latency);
+	}
+	return undecided;
+}
+
+sim_batch::sim_batch(const sim_ooo &prototype){
+	this->prototype = new sim_ooo(prototype);
+	simulations = 0;
+}
+
+sim_batch::~sim_batch(){
+	delete prototype;
+}
+
+unsigned sim_batch::add_instance(const unsigned latency[NUM_UNIT_TYPES]){
+	for (unsigned t=0; t<NUM_UNIT_TYPES; t++)
+		if ((prototype->get_unit_types() & (1 << t)) && latency[t] == 0) throw sim_error("batched instances need unit latencies of at least 1 cycle!");
+	latencies.push_back(vector<unsigned>(latency, latency+NUM_UNIT_TYPES));
+	return latencies.size()-1;
+}
+
+const sim_result_t &sim_batch::get_result(unsigned instance){return results[instance];}
+
+unsigned sim_batch::get_simulations(){return simulations;}
+
+void sim_batch::run(unsigned cycles){
+	results.resize(latencies.size());
+	simulations = 0;
+	if (latencies.empty()) return;
+	unsigned types = prototype->get_unit_types();
+
+	vector<batch_group_t> groups;
+	batch_group_t first;
+	first.sim = new sim_ooo(*prototype);
+	for (unsigned i=0; i<latencies.size(); i++) first.members.push_back(i);
+	first.cycles = 0;
+	groups.push_back(first);
+	simulations++;
+
+	while (!groups.empty()){
+		batch_group_t group = groups.back();
+		groups.pop_back();
+		bool error = false;
+		try{
+			unsigned undecided = program_latencies(group, latencies, types);
+			while (!group.sim->is_finished() && (cycles == 0 || group.cycles < cycles)){
+				if (undecided == 0){
+					group.sim->run(cycles == 0 ? 0 : cycles - group.cycles);
+					break;
+				}
+				group.sim->run(1);
+				group.cycles++;
+
+				// operations dispatched to undecided units: the members diverge here
+				unsigned diverging = group.sim->get_dispatched_unit_types() & undecided;
+				if (diverging == 0) continue;
+
+				// partition the members by their latencies of the diverging unit types
+				map< vector<unsigned>, vector<unsigned> > partitions;
+				for (unsigned m=0; m<group.members.size(); m++){
+					vector<unsigned> key;
+					for (unsigned t=0; t<NUM_UNIT_TYPES; t++)
+						if (diverging & (1 << t)) key.push_back(latencies[group.members[m]][t]);
+					partitions[key].push_back(group.members[m]);
+				}
+
+				// every partition but the last continues on a copy; the last one keeps the simulation
+				map< vector<unsigned>, vector<unsigned> >::iterator p = partitions.begin();
+				for (unsigned n=0; n+1<partitions.size(); n++, p++){
+					batch_group_t fork;
+					fork.sim = new sim_ooo(*group.sim);
+					fork.members = p->second;
+					fork.cycles = group.cycles;
+					groups.push_back(fork);
+					simulations++;
+				}
+				group.members = p->second;
+				undecided = program_latencies(group, latencies, types);
+			}
+		} catch (const sim_error &e){
+			error = true;
+		}
+		for (unsigned m=0; m<group.members.size(); m++)
+			results[group.members[m]] = collect_result(group.sim, group.members[m], error);
+		delete group.sim;
+	}
+}
+
+/* =============================================================
+
+   SWEEP
+
+   ============================================================= */
+
+sim_sweep::sim_sweep(const char *filename, unsigned base_address, unsigned mem_size){
+	parse_program(filename, program);
+	this->base_address = base_address;
+	this->mem_size = mem_size;
+	max_cycles = 0;
+	batch_size = 16;
+}
+
+void sim_sweep::add_config(const sim_config_t &config){
+	configs.push_back(config);
+}
+
+void sim_sweep::add_grid(const sim_grid_t &grid){
+	// one vector per dimension, walked like an odometer
+	static const vector<unsigned> single_commit(1, 1);
+	static const vector<unsigned> unlimited_cdbs(1, 0);
+	const vector<unsigned> *dims[8+2*NUM_UNIT_TYPES] = {&grid.rob_size, &grid.num_int_res_stations, &grid.num_add_res_stations,
+		&grid.num_mul_res_stations, &grid.num_load_buffers, &grid.issue_width};
+	unsigned num_dims = 6;
+	for (unsigned u=0; u<NUM_UNIT_TYPES; u++){
+		dims[num_dims++] = &grid.latency[u];
+		dims[num_dims++] = &grid.instances[u];
+	}
+	dims[num_dims++] = grid.commit_width.empty() ? &single_commit : &grid.commit_width;
+	dims[num_dims++] = grid.num_cdbs.empty() ? &unlimited_cdbs : &grid.num_cdbs;
+	for (unsigned d=0; d<num_dims; d++) if (dims[d]->empty()) return;
+
+	unsigned index[8+2*NUM_UNIT_TYPES] = {0};
+	while (true){
+		sim_config_t config;
+		config.mem_size = mem_size;
+		config.rob_size = (*dims[0])[index[0]];
+		config.num_int_res_stations = (*dims[1])[index[1]];
+		config.num_add_res_stations = (*dims[2])[index[2]];
+		config.num_mul_res_stations = (*dims[3])[index[3]];
+		config.num_load_buffers = (*dims[4])[index[4]];
+		config.issue_width = (*dims[5])[index[5]];
+		for (unsigned u=0; u<NUM_UNIT_TYPES; u++){
+			config.units[u].latency = (*dims[6+2*u])[index[6+2*u]];
+			config.units[u].instances = (*dims[7+2*u])[index[7+2*u]];
+		}
+		config.commit_width = (*dims[6+2*NUM_UNIT_TYPES])[index[6+2*NUM_UNIT_TYPES]];
+		config.num_cdbs = (*dims[7+2*NUM_UNIT_TYPES])[index[7+2*NUM_UNIT_TYPES]];
+		configs.push_back(config);
+
+		unsigned d = num_dims;
+		while (d > 0){
+			d--;
+			if (++index[d] < dims[d]->size()) break;
+			index[d] = 0;
+			if (d == 0) return;
+		}
+	}
+}
+
+unsigned sim_sweep::get_num_configs(){return configs.size();}
+
+const sim_config_t &sim_sweep::get_config(unsigned index){return configs[index];}
+
+void sim_sweep::set_max_cycles(unsigned cycles){max_cycles = cycles;}
+
+void sim_sweep::set_batch_size(unsigned size){batch_size = size == 0 ? 1 : size;}
+
+void sim_sweep::set_register(unsigned reg, unsigned value){
+	sim_init_t init = {reg, value};
+	registers.push_back(init);
+}
+
+void sim_sweep::write_memory(unsigned address, unsigned value){
+	sim_init_t init = {address, value};
+	memory.push_back(init);
+}
+
+void sim_sweep::load_memory_image(const char *filename, unsigned base_address){
+	sim_memory check(mem_size);
+	check.map_image(filename, base_address); // fail now rather than in a worker thread
+	images.push_back(make_pair(string(filename), base_address));
+}
+
+/* builds and initializes the simulator for one design point */
+sim_ooo *sim_sweep::build_config(unsigned index){
+	const sim_config_t &config = configs[index];
+	sim_ooo *ooo = new sim_ooo(config.mem_size, config.rob_size,
+				   config.num_int_res_stations, config.num_add_res_stations,
+				   config.num_mul_res_stations, config.num_load_buffers,
+				   config.issue_width, config.commit_width);
+	ooo->set_cdbs(config.num_cdbs);
+	try{
+		for (unsigned u=0; u<NUM_UNIT_TYPES; u++)
+			if (config.units[u].instances > 0)
+				ooo->init_exec_unit((exe_unit_t)u, config.units[u].latency, config.units[u].instances);
+		ooo->load_program(program, base_address);
+		for (unsigned i=0; i<registers.size(); i++){
+			unsigned value = registers[i].value;
+			if (registers[i].location < NUM_GP_REGISTERS) ooo->set_int_register(registers[i].location, value);
+			else{
+				float f;
+				memcpy(&f, &value, sizeof value);
+				ooo->set_fp_register(registers[i].location - NUM_GP_REGISTERS, f);
+			}
+		}
+		for (unsigned i=0; i<images.size(); i++) ooo->load_memory_image(images[i].first.c_str(), images[i].second);
+		for (unsigned i=0; i<memory.size(); i++) ooo->write_memory(memory[i].location, memory[i].value);
+	} catch (const sim_error &e){
+		delete ooo;
+		throw;
+	}
+	return ooo;
+}
+
+/* runs the simulator for one design point; a point that cannot be built or run is reported as an error row */
+sim_result_t sim_sweep::run_config(unsigned index){
+	sim_ooo *ooo = NULL;
+	bool error = false;
+	try{
+		ooo = build_config(index);
+		ooo->run(max_cycles);
+	} catch (const sim_error &e){
+		error = true;
+	}
+	if (ooo == NULL) return error_result(index); // invalid configuration: zero counters
+	sim_result_t result = collect_result(ooo, index, error);
+	delete ooo;
+	return result;
+}
+
+/* runs design points differing only in unit latencies as one batch */
+void sim_sweep::run_batch(const vector<unsigned> &indexes, vector<sim_result_t> &results){
+	sim_ooo *ooo;
+	try{
+		ooo = build_config(indexes[0]);
+	} catch (const sim_error &e){
+		// the instances differ only in latencies: none of them can be built
+		for (unsigned i=0; i<indexes.size(); i++) results[indexes[i]] = error_result(indexes[i]);
+		return;
+	}
+	sim_batch batch(*ooo);
+	delete ooo;
+	for (unsigned i=0; i<indexes.size(); i++){
+		unsigned latency[NUM_UNIT_TYPES];
+		for (unsigned u=0; u<NUM_UNIT_TYPES; u++) latency[u] = configs[indexes[i]].units[u].latency;
+		batch.add_instance(latency);
+	}
+	batch.run(max_cycles);
+	for (unsigned i=0; i<indexes.size(); i++){
+		results[indexes[i]] = batch.get_result(i);
+		results[indexes[i]].config = indexes[i];
+	}
+}
+
+/* true if the two design points differ at most in unit latencies */
+static bool same_but_latencies(const sim_config_t &a, const sim_config_t &b){
+	if (a.mem_size != b.mem_size || a.rob_size != b.rob_size || a.issue_width != b.issue_width || a.commit_width != b.commit_width ||
+	    a.num_cdbs != b.num_cdbs ||
+	    a.num_int_res_stations != b.num_int_res_stations || a.num_add_res_stations != b.num_add_res_stations ||
+	    a.num_mul_res_stations != b.num_mul_res_stations || a.num_load_buffers != b.num_load_buffers) return false;
+	for (unsigned u=0; u<NUM_UNIT_TYPES; u++)
+		if (a.units[u].instances != b.units[u].instances) return false;
+	return true;
+}
+
+/* true if the design point can be part of a batch (sim_batch needs latencies >= 1) */
+static bool batchable(const sim_config_t &config){
+	for (unsigned u=0; u<NUM_UNIT_TYPES; u++)
+		if (config.units[u].instances > 0 && config.units[u].latency == 0) return false;
+	return true;
+}
+
+vector<sim_result_t> sim_sweep::run(unsigned num_threads){
+	vector<sim_result_t> results(configs.size());
+	if (configs.empty()) return results;
+
+	// tasks: single design points, or batches of up to batch_size latency-only variants
+	vector< vector<unsigned> > tasks;
+	vector<bool> assigned(configs.size(), false);
+	for (unsigned i=0; i<configs.size(); i++){
+		if (assigned[i]) continue;
+		vector<unsigned> task(1, i);
+		assigned[i] = true;
+		if (batchable(configs[i]))
+			for (unsigned j=i+1; j<configs.size() && task.size()<batch_size; j++)
+				if (!assigned[j] && batchable(configs[j]) && same_but_latencies(configs[i], configs[j])){
+					task.push_back(j);
+					assigned[j] = true;
+				}
+		tasks.push_back(task);
+	}
+
+	if (num_threads == 0) num_threads = thread::hardware_concurrency();
+	if (num_threads == 0) num_threads = 1;
+	if (num_threads > tasks.size()) num_threads = tasks.size();
+
+	// contiguous blocks, one per worker
+	work_queue_t *queues = new work_queue_t[num_threads];
+	for (unsigned i=0; i<tasks.size(); i++)
+		queues[(unsigned long)i*num_threads/tasks.size()].tasks.push_back(i);
+
+	vector<thread> workers;
+	for (unsigned t=0; t<num_threads; t++){
+		workers.push_back(thread([this, queues, num_threads, t, &tasks, &results](){
+			unsigned task;
+			while (pop_task(&queues[t], &task) || steal_task(queues, num_threads, t, &task)){
+				if (tasks[task].size() == 1) results[tasks[task][0]] = run_config(tasks[task][0]);
+				else run_batch(tasks[task], results);
+			}
+		}));
+	}
+	for (unsigned t=0; t<num_threads; t++) workers[t].join();
+
+	delete [] queues;
+	return results;
+}
+
+void sim_sweep::print_results(const vector<sim_result_t> &results, ostream &out){
+	static const char *unit_names[NUM_UNIT_TYPES] = {"int", "add", "mult", "div", "mem"};
+	out << "config,rob,int_rs,add_rs,mult_rs,load_b,issue_width,commit_width,cdbs";
+	for (unsigned u=0; u<NUM_UNIT_TYPES; u++) out << "," << unit_names[u] << "_lat," << unit_names[u] << "_units";
+	out << ",instructions,cycles,ipc,rob_stalls,rs_stalls,cdb_conflicts,finished,error" << endl;
+	for (unsigned i=0; i<results.size(); i++){
+		const sim_result_t &r = results[i];
+		const sim_config_t &c = configs[r.config];
+		out << dec << r.config << "," << c.rob_size << "," << c.num_int_res_stations << "," << c.num_add_res_stations
+		    << "," << c.num_mul_res_stations << "," << c.num_load_buffers << "," << c.issue_width << "," << c.commit_width << "," << c.num_cdbs;
+		for (unsigned u=0; u<NUM_UNIT_TYPES; u++) out << "," << c.units[u].latency << "," << c.units[u].instances;
+		out << "," << r.instructions_executed << "," << r.clock_cycles << "," << r.ipc
+		    << "," << r.rob_stalls << "," << r.rs_stalls << "," << r.cdb_conflicts << "," << (r.finished ? 1 : 0) << "," << (r.error ? 1 : 0) << endl;
+	}
+}
@@ -0,0 +1,180 @@
+#ifndef SIM_SWEEP_H_
+#define SIM_SWEEP_H_
+
+#include "sim_ooo.h"
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+// execution units of a given type in a design point
+typedef struct{
+	unsigned latency;   // latency of each unit (in clock cycles)
+	unsigned instances; // number of units of this type (0 = none)
+} unit_config_t;
+
+// one design point (i.e., one sim_ooo instance)
+typedef struct{
+	unsigned mem_size;		// size of data memory (in byte)
+	unsigned rob_size;		// number of ROB entries
+	unsigned num_int_res_stations;	// number of integer reservation stations
+	unsigned num_add_res_stations;	// number of ADD reservation stations
+	unsigned num_mul_res_stations;	// number of MULT/DIV reservation stations
+	unsigned num_load_buffers;	// number of LOAD buffers
+	unsigned issue_width;		// issue width
+	unsigned commit_width;		// commit (retire) width
+	unsigned num_cdbs;		// common data buses (0 = unlimited)
+	unit_config_t units[NUM_UNIT_TYPES]; // execution units, indexed by exe_unit_t
+} sim_config_t;
+
+// grid of design points: every combination of the listed values is simulated
+typedef struct{
+	vector<unsigned> rob_size;
+	vector<unsigned> num_int_res_stations;
+	vector<unsigned> num_add_res_stations;
+	vector<unsigned> num_mul_res_stations;
+	vector<unsigned> num_load_buffers;
+	vector<unsigned> issue_width;
+	vector<unsigned> latency[NUM_UNIT_TYPES];
+	vector<unsigned> instances[NUM_UNIT_TYPES];
+	vector<unsigned> commit_width;	// empty = 1
+	vector<unsigned> num_cdbs;	// empty = 0 (unlimited)
+} sim_grid_t;
+
+// outcome of the simulation of one design point
+typedef struct{
+	unsigned config;		// index of the design point
+	unsigned instructions_executed;
+	unsigned clock_cycles;
+	float ipc;
+	unsigned rob_stalls;
+	unsigned rs_stalls;
+	unsigned cdb_conflicts;
+	bool finished;			// false if the cycle limit was hit first
+	bool error;			// true if the simulator raised a sim_error (e.g., invalid configuration)
+} sim_result_t;
+
+// simulates instances of one configuration that differ only in execution unit latencies
+// Latencies only matter when an operation is dispatched, so instances are simulated together
+// as long as no operation is dispatched to a unit type whose latency differs among them; at that
+// point the simulation is copied, once per distinct latency, and the copies are retimed and
+// continue separately (recursively, as they may still differ in other unit types).
+class sim_batch{
+
+	//initialized simulator (program, registers, data memory) all instances start from
+	sim_ooo *prototype;
+
+	//latency of each unit type, per instance
+	vector< vector<unsigned> > latencies;
+
+	//per instance outcome
+	vector<sim_result_t> results;
+
+	//number of simulations actually run (1 + number of forks)
+	unsigned simulations;
+
+public:
+
+	//copies the prototype; its execution units define the unit types and counts of all instances
+	sim_batch(const sim_ooo &prototype);
+
+	~sim_batch();
+
+	//adds an instance with the given latency per unit type (indexed by exe_unit_t) and returns its index
+	//throws sim_error if a unit type present in the prototype is given a latency of 0
+	unsigned add_instance(const unsigned latency[NUM_UNIT_TYPES]);
+
+	//runs all instances for "cycles" clock cycles (to completion if cycles=0)
+	void run(unsigned cycles=0);
+
+	//returns the outcome of the given instance (the "config" field is the instance index)
+	const sim_result_t &get_result(unsigned instance);
+
+	//returns the number of simulations run by the last call to run()
+	unsigned get_simulations();
+};
+
+// initial value of a data memory word or register, shared by all design points
+typedef struct{
+	unsigned location; // address, or register index (0-31 integer, 32-63 floating point)
+	unsigned value;
+} sim_init_t;
+
+class sim_sweep{
+
+	//decoded program, copied into every simulator instance
+	instruction_t program[PROGRAM_SIZE];
+	unsigned base_address;
+
+	//data memory size used for design points added through add_grid
+	unsigned mem_size;
+
+	//cycle limit for each design point (0 = run to completion)
+	unsigned max_cycles;
+
+	//maximum number of latency-only variants simulated together (1 = no batching)
+	unsigned batch_size;
+
+	//design points
+	vector<sim_config_t> configs;
+
+	//initial architectural state
+	vector<sim_init_t> registers;
+	vector<sim_init_t> memory;
+	vector<pair<string, unsigned> > images; // memory image files and their base addresses
+
+	//builds and initializes the simulator for the design point with the given index
+	//throws sim_error if the design point is invalid
+	sim_ooo *build_config(unsigned index);
+
+	//simulates the design point with the given index
+	sim_result_t run_config(unsigned index);
+
+	//simulates design points that differ only in unit latencies as one sim_batch
+	void run_batch(const vector<unsigned> &indexes, vector<sim_result_t> &results);
+
+public:
+
+	//decodes the assembly program in file "filename" once for the whole sweep
+	//throws sim_error if the program cannot be parsed
+	sim_sweep(const char *filename, unsigned base_address=0x0, unsigned mem_size=1024*1024);
+
+	//adds a single design point
+	void add_config(const sim_config_t &config);
+
+	//adds every design point of the grid (empty dimensions are not allowed)
+	void add_grid(const sim_grid_t &grid);
+
+	//number of design points
+	unsigned get_num_configs();
+
+	//returns the design point with the given index
+	const sim_config_t &get_config(unsigned index);
+
+	//sets the cycle limit of each run (0 = run to completion)
+	void set_max_cycles(unsigned cycles);
+
+	//sets the maximum number of design points differing only in unit latencies that
+	//are simulated together by one sim_batch (default 16, 1 = simulate each point on its own)
+	void set_batch_size(unsigned size);
+
+	//initial register value (0-31 integer registers, 32-63 floating point registers, raw bits)
+	void set_register(unsigned reg, unsigned value);
+
+	//initial data memory word (little-endian)
+	void write_memory(unsigned address, unsigned value);
+
+	//initial data memory content from a binary file, mapped at the given address by every design point
+	//(before the words set by write_memory); throws sim_error if the file cannot be mapped
+	void load_memory_image(const char *filename, unsigned base_address);
+
+	//simulates all design points on "num_threads" threads (0 = one per hardware thread)
+	//results are returned in design point order; a failing design point does not affect the others
+	vector<sim_result_t> run(unsigned num_threads=0);
+
+	//prints one CSV row per design point
+	void print_results(const vector<sim_result_t> &results, ostream &out);
+};
+
+#endif /*SIM_SWEEP_H_*/
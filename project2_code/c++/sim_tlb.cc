@@ -0,0 +1,71 @@
+#include "sim_tlb.h"
+#include "sim_ooo.h"
+
+using namespace std;
+
+sim_tlb::sim_tlb(){
+	entries = 0;
+	associativity = 1;
+	page_bits = 12;
+	level_latency = 0;
+	walk_levels = 0;
+	time = 0;
+	accesses = 0;
+	misses = 0;
+}
+
+void sim_tlb::init(unsigned entries, unsigned associativity, unsigned page_size, unsigned level_latency){
+	if (entries == 0 || associativity == 0 || entries % associativity != 0)
+		throw sim_error("TLB entries must be a non-zero multiple of the associativity!");
+	if (!is_power_of_2(page_size))
+		throw sim_error("TLB page size must be a power of 2!");
+	this->entries = entries;
+	this->associativity = associativity;
+	this->level_latency = level_latency;
+	page_bits = 0;
+	while ((1u << page_bits) < page_size) page_bits++;
+	walk_levels = (32 - page_bits + 9) / 10; // 1024 entries (10 bits) per level
+	if (walk_levels == 0) walk_levels = 1;
+	vpns.assign(entries, UNDEFINED);
+	last_use.assign(entries, 0);
+	flush();
+}
+
+bool sim_tlb::enabled(){return entries != 0;}
+
+unsigned sim_tlb::access(unsigned address){
+	if (entries == 0) return 0;
+	accesses++;
+	time++;
+	unsigned vpn = address >> page_bits;
+	unsigned set = vpn % (entries / associativity);
+	unsigned first = set * associativity;
+	unsigned victim = first;
+	for (unsigned w=first; w<first+associativity; w++){
+		if (vpns[w] == vpn){
+			last_use[w] = time;
+			return 0;
+		}
+		if (vpns[w] == UNDEFINED || (vpns[victim] != UNDEFINED && last_use[w] < last_use[victim])) victim = w;
+	}
+	misses++;
+	vpns[victim] = vpn;
+	last_use[victim] = time;
+	return get_walk_latency();
+}
+
+void sim_tlb::flush(){
+	for (unsigned w=0; w<vpns.size(); w++){
+		vpns[w] = UNDEFINED;
+		last_use[w] = 0;
+	}
+	time = 0;
+	accesses = 0;
+	misses = 0;
+}
+
+unsigned sim_tlb::get_walk_latency(){return walk_levels * level_latency;}
+
+unsigned sim_tlb::get_accesses(){return accesses;}
+
+unsigned sim_tlb::get_misses(){return misses;}
@@ -0,0 +1,56 @@
+#ifndef SIM_TLB_H_
+#define SIM_TLB_H_
+
+#include <vector>
+
+using namespace std;
+
+// data TLB with a page-walk latency model
+// Set-associative, LRU replacement, one page size per TLB (e.g., 4KB, or 2MB/4MB huge pages).
+// On a miss the page table of a 32-bit address space is walked: a radix table with 1024
+// entries per level, so 4KB pages take 2 levels and 4MB pages 1 level, each costing
+// "level_latency" cycles. Hits add no latency (the lookup overlaps the memory access).
+class sim_tlb{
+
+	//configuration (entries = 0: TLB disabled)
+	unsigned entries;
+	unsigned associativity;
+	unsigned page_bits;	// log2(page size)
+	unsigned level_latency;
+	unsigned walk_levels;
+
+	//content: per way, virtual page number (UNDEFINED if invalid) and last access time
+	vector<unsigned> vpns;
+	vector<unsigned long> last_use;
+	unsigned long time;
+
+	//statistics
+	unsigned accesses;
+	unsigned misses;
+
+public:
+
+	//creates a disabled TLB
+	sim_tlb();
+
+	//configures the TLB (entries must be a multiple of associativity, page_size a power of 2)
+	//throws sim_error on an invalid configuration
+	void init(unsigned entries, unsigned associativity, unsigned page_size, unsigned level_latency);
+
+	//true if the TLB has been configured
+	bool enabled();
+
+	//translates the address; returns the extra latency (page walk) in clock cycles
+	unsigned access(unsigned address);
+
+	//invalidates all entries and clears the statistics
+	void flush();
+
+	//number of cycles of a page walk
+	unsigned get_walk_latency();
+
+	unsigned get_accesses();
+	unsigned get_misses();
+};
+
+#endif /*SIM_TLB_H_*/
@@ -0,0 +1,59 @@
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stddef.h>
+#include <atomic>
+
+using namespace std;
+
+// lock-free single-producer/single-consumer ring buffer
+// push() must only be called by one thread and pop() by one (other) thread
+template <typename T>
+class spsc_ring{
+
+	T *buffer;
+	size_t mask;	// capacity - 1 (capacity is a power of 2)
+
+	// indexes grow forever and are wrapped with mask; kept on separate cache lines
+	alignas(64) atomic<size_t> head;	// next slot to read (written by the consumer)
+	alignas(64) atomic<size_t> tail;	// next slot to write (written by the producer)
+
+	spsc_ring(const spsc_ring &);
+	spsc_ring &operator=(const spsc_ring &);
+
+public:
+
+	//creates a ring holding at least "capacity" items
+	spsc_ring(size_t capacity){
+		size_t size = 1;
+		while (size < capacity) size <<= 1;
+		buffer = new T[size];
+		mask = size - 1;
+		head.store(0, memory_order_relaxed);
+		tail.store(0, memory_order_relaxed);
+	}
+
+	~spsc_ring(){
+		delete [] buffer;
+	}
+
+	//appends an item; returns false if the ring is full (producer side)
+	bool push(const T &item){
+		size_t t = tail.load(memory_order_relaxed);
+		if (t - head.load(memory_order_acquire) > mask) return false;
+		buffer[t & mask] = item;
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+
+	//removes the oldest item; returns false if the ring is empty (consumer side)
+	bool pop(T &item){
+		size_t h = head.load(memory_order_relaxed);
+		if (h == tail.load(memory_order_acquire)) return false;
+		item = buffer[h & mask];
+		head.store(h + 1, memory_order_release);
+		return true;
+	}
+};
+
+#endif /*SPSC_RING_H_*/
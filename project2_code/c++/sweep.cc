@@ -0,0 +1,159 @@
+#include "sim_sweep.h"
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Design-space sweep driver
+
+   usage: sweep <sweep file> [threads]
+
+   The sweep file lists the program, its initial state and the design points:
+
+	program asm/code_ooo.asm	# assembly program (loaded at address 0x0)
+	memory 1048576			# data memory size in byte (default 1MB)
+	max_cycles 100000		# cycle limit of each run (default 0 = run to completion)
+	batch 16			# latency-only variants simulated together (default 16, 1 = off)
+	reg R1 10			# initial register value (R0-R31, F0-F31)
+	reg F2 20.0
+	mem 0x14 10.0			# initial data memory word
+	image data.bin 0x1000		# initial data memory content from a binary file
+	# rob int add mult load issue int_lat int_n add_lat add_n mult_lat mult_n div_lat div_n mem_lat mem_n [commit [cdbs]]
+	config 6 1 2 2 2 1  2 1  2 2  10 1  40 1  1 1
+
+   The last two fields of a "config" line are optional: the commit width (default 1) and the number of
+   common data buses (default 0, unlimited; oldest-first arbitration).
+   Every field of a "config" line can be a comma-separated list of values:
+   the line then expands to every combination of the listed values.
+   One CSV row per design point is written to the standard output. */
+
+/* parses an integer or, if it contains a '.', a float (returned as raw bits) */
+static unsigned parse_value(const string &token){
+	if (token.find('.') != string::npos){
+		float f = strtof(token.c_str(), NULL);
+		unsigned result;
+		memcpy(&result, &f, sizeof f);
+		return result;
+	}
+	return strtoul(token.c_str(), NULL, 0);
+}
+
+/* parses a comma-separated list of values */
+static vector<unsigned> parse_list(const string &token){
+	vector<unsigned> values;
+	stringstream ss(token);
+	string item;
+	while (getline(ss, item, ',')) values.push_back(strtoul(item.c_str(), NULL, 0));
+	return values;
+}
+
+int main(int argc, char **argv){
+
+	if (argc < 2){
+		cerr << "usage: " << argv[0] << " <sweep file> [threads]" << endl;
+		return 1;
+	}
+	unsigned num_threads = argc > 2 ? strtoul(argv[2], NULL, 0) : 0;
+
+	ifstream fin(argv[1]);
+	if (!fin.is_open()){
+		cerr << "error: open file " << argv[1] << " failed!" << endl;
+		return 1;
+	}
+
+	string program;
+	unsigned mem_size = 1024*1024;
+	unsigned max_cycles = 0;
+	unsigned batch_size = 16;
+	vector<sim_init_t> registers;
+	vector<sim_init_t> memory;
+	vector<pair<string, unsigned> > images;
+	vector<sim_grid_t> grids;
+
+	string line;
+	unsigned line_nr = 0;
+	while (getline(fin, line)){
+		line_nr++;
+		line = line.substr(0, line.find('#'));
+		stringstream ss(line);
+		string key;
+		if (!(ss >> key)) continue;
+		if (key == "program") ss >> program;
+		else if (key == "memory"){ string v; ss >> v; mem_size = parse_value(v); }
+		else if (key == "max_cycles"){ string v; ss >> v; max_cycles = parse_value(v); }
+		else if (key == "batch"){ string v; ss >> v; batch_size = parse_value(v); }
+		else if (key == "reg"){
+			string reg, value;
+			ss >> reg >> value;
+			sim_init_t init = {(unsigned)atoi(reg.c_str()+1), parse_value(value)};
+			if (reg[0] == 'F') init.location += NUM_GP_REGISTERS;
+			registers.push_back(init);
+		}
+		else if (key == "mem"){
+			string address, value;
+			ss >> address >> value;
+			sim_init_t init = {parse_value(address), parse_value(value)};
+			memory.push_back(init);
+		}
+		else if (key == "image"){
+			string file, address;
+			ss >> file >> address;
+			images.push_back(make_pair(file, parse_value(address)));
+		}
+		else if (key == "config"){
+			vector<unsigned> *fields[6+2*NUM_UNIT_TYPES];
+			sim_grid_t grid;
+			fields[0] = &grid.rob_size;
+			fields[1] = &grid.num_int_res_stations;
+			fields[2] = &grid.num_add_res_stations;
+			fields[3] = &grid.num_mul_res_stations;
+			fields[4] = &grid.num_load_buffers;
+			fields[5] = &grid.issue_width;
+			for (unsigned u=0; u<NUM_UNIT_TYPES; u++){
+				fields[6+2*u] = &grid.latency[u];
+				fields[7+2*u] = &grid.instances[u];
+			}
+			string token;
+			unsigned f = 0;
+			while (f < 6+2*NUM_UNIT_TYPES && ss >> token) *fields[f++] = parse_list(token);
+			if (f != 6+2*NUM_UNIT_TYPES){
+				cerr << "error: line " << line_nr << ": config needs " << 6+2*NUM_UNIT_TYPES << " fields" << endl;
+				return 1;
+			}
+			if (ss >> token) grid.commit_width = parse_list(token);
+			if (ss >> token) grid.num_cdbs = parse_list(token);
+			grids.push_back(grid);
+		}
+		else{
+			cerr << "error: line " << line_nr << ": unknown keyword " << key << endl;
+			return 1;
+		}
+	}
+	if (program.empty()){
+		cerr << "error: no program specified" << endl;
+		return 1;
+	}
+
+	try{
+		sim_sweep sweep(program.c_str(), 0x0, mem_size);
+		sweep.set_max_cycles(max_cycles);
+		sweep.set_batch_size(batch_size);
+		for (unsigned i=0; i<registers.size(); i++) sweep.set_register(registers[i].location, registers[i].value);
+		for (unsigned i=0; i<images.size(); i++) sweep.load_memory_image(images[i].first.c_str(), images[i].second);
+		for (unsigned i=0; i<memory.size(); i++) sweep.write_memory(memory[i].location, memory[i].value);
+		for (unsigned i=0; i<grids.size(); i++) sweep.add_grid(grids[i]);
+
+		vector<sim_result_t> results = sweep.run(num_threads);
+		sweep.print_results(results, cout);
+	} catch (const sim_error &e){
+		cerr << "error: " << e.what() << endl;
+		return 1;
+	}
+
+	return 0;
+}
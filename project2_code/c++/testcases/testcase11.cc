@@ -0,0 +1,75 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+#include "sim_sweep.h"
+
+using namespace std;
+
+/* Test case for the design-space sweep: testcase1 over a grid of design points, on 4 threads */
+/* (the first design point is testcase1: same instructions and clock cycles as testcase1.out) */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* convert an unsigned into a float */
+inline float unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+	unsigned i;
+
+	// sweeps asm/code_ooo.asm (testcase1 program and data) over 8 design points
+	sim_sweep sweep("asm/code_ooo.asm", 0x00000000, 1024*1024);
+
+	//initialize general purpose registers (0-31 integer, 32-63 floating point)
+	sweep.set_register(1, 10);
+	sweep.set_register(2, 20);
+	sweep.set_register(3, 10);
+	for (i=0; i<11; i++) sweep.set_register(32+i, float2unsigned((float)i*10.0));
+
+	//initialize data memory
+	sweep.write_memory(0x14, float2unsigned(10.0));
+	sweep.write_memory(0x28, float2unsigned(30.0));
+
+	//design points: rob size x issue width x multiplier latency (the first one is testcase1)
+	sim_grid_t grid;
+	grid.rob_size.push_back(6);
+	grid.rob_size.push_back(4);
+	grid.num_int_res_stations.push_back(1);
+	grid.num_add_res_stations.push_back(2);
+	grid.num_mul_res_stations.push_back(2);
+	grid.num_load_buffers.push_back(2);
+	grid.issue_width.push_back(1);
+	grid.issue_width.push_back(2);
+	grid.latency[INTEGER].push_back(2);	grid.instances[INTEGER].push_back(1);
+	grid.latency[ADDER].push_back(2);	grid.instances[ADDER].push_back(2);
+	grid.latency[MULTIPLIER].push_back(10);	grid.instances[MULTIPLIER].push_back(1);
+	grid.latency[MULTIPLIER].push_back(4);
+	grid.latency[DIVIDER].push_back(40);	grid.instances[DIVIDER].push_back(1);
+	grid.latency[MEMORY].push_back(1);	grid.instances[MEMORY].push_back(1);
+	sweep.add_grid(grid);
+
+	cout << "Design points = " << dec << sweep.get_num_configs() << endl << endl;
+
+	//simulates the design points on 4 threads
+	vector<sim_result_t> results = sweep.run(4);
+	sweep.print_results(results, cout);
+	cout << endl;
+
+	//the results do not depend on the number of threads
+	vector<sim_result_t> serial = sweep.run(1);
+	bool same = serial.size() == results.size();
+	for (i=0; same && i<results.size(); i++)
+		same = serial[i].config == results[i].config && serial[i].clock_cycles == results[i].clock_cycles
+		       && serial[i].instructions_executed == results[i].instructions_executed;
+	cout << "Same results on 1 thread = " << (same ? "yes" : "no") << endl;
+}
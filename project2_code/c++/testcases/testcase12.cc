@@ -0,0 +1,102 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+#include "sim_sweep.h"
+
+using namespace std;
+
+/* Test case for error handling: invalid programs and configurations raise sim_error instead of terminating the process */
+/* (the program of testcase1 survives two failed loads: same instructions, clock cycles and log as testcase1.out) */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+int main(int argc, char **argv){
+	unsigned i;
+
+	// testcase1 processor
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 1, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 2, 1);
+	ooo->init_exec_unit(ADDER, 2, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+
+	// too many execution units (MAX_UNITS = 10)
+	try{
+		ooo->init_exec_unit(MEMORY, 1, 5);
+		cout << "init_exec_unit: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_exec_unit: " << e.what() << endl;
+	}
+
+	ooo->load_program("asm/code_ooo.asm", 0x00000000);
+
+	// failed loads leave the program of testcase1 in place
+	try{
+		ooo->load_program("asm/bad_opcode.asm", 0x00000000);
+		cout << "load_program: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "load_program: " << e.what() << endl;
+	}
+	try{
+		ooo->load_program("asm/missing.asm", 0x00000000);
+		cout << "load_program: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "load_program: " << e.what() << endl;
+	}
+
+	ooo->set_int_register(1, 10);
+	ooo->set_int_register(2, 20);
+	ooo->set_int_register(3, 10);
+	for (i=0; i<11; i++) ooo->set_fp_register(i, (float)i*10.0);
+	ooo->write_memory(0x14,float2unsigned(10.0));
+	ooo->write_memory(0x28,float2unsigned(30.0));
+	ooo->run();
+
+	// the log goes to the given stream only
+	stringstream log;
+	ooo->print_log(log);
+	cout << endl << "Captured log:" << endl << log.str() << endl;
+	cout << "Instruction executed = " << dec << ooo->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+
+	// a sweep keeps going when a design point is invalid: the second point has 11 units
+	sim_sweep sweep("asm/code_ooo.asm", 0x00000000, 1024*1024);
+	sweep.set_register(1, 10);
+	sweep.set_register(2, 20);
+	sweep.set_register(3, 10);
+	for (i=0; i<11; i++) sweep.set_register(32+i, float2unsigned((float)i*10.0));
+	sweep.write_memory(0x14, float2unsigned(10.0));
+	sweep.write_memory(0x28, float2unsigned(30.0));
+	sim_grid_t grid;
+	grid.rob_size.push_back(6);
+	grid.num_int_res_stations.push_back(1);
+	grid.num_add_res_stations.push_back(2);
+	grid.num_mul_res_stations.push_back(2);
+	grid.num_load_buffers.push_back(2);
+	grid.issue_width.push_back(1);
+	grid.latency[INTEGER].push_back(2);	grid.instances[INTEGER].push_back(1);
+	grid.latency[ADDER].push_back(2);	grid.instances[ADDER].push_back(2);
+	grid.latency[MULTIPLIER].push_back(10);	grid.instances[MULTIPLIER].push_back(1);
+	grid.latency[DIVIDER].push_back(40);	grid.instances[DIVIDER].push_back(1);
+	grid.latency[MEMORY].push_back(1);	grid.instances[MEMORY].push_back(1);
+	grid.instances[MEMORY].push_back(6);
+	sweep.add_grid(grid);
+	sweep.print_results(sweep.run(2), cout);
+
+	// a sweep over a program that cannot be parsed
+	try{
+		sim_sweep bad("asm/bad_opcode.asm");
+		cout << "sim_sweep: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "sim_sweep: " << e.what() << endl;
+	}
+}
@@ -0,0 +1,85 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+#include "sim_sweep.h"
+
+using namespace std;
+
+/* Test case for batched simulation: latency-only variants of testcase9 simulated as one sim_batch */
+/* (each instance must match a standalone run; INT 3/MEM 5 is testcase9: 652 instructions, 2066 clock cycles) */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* testcase9 processor and initial state, with the given integer and memory latencies */
+sim_ooo *build(unsigned int_latency, unsigned mem_latency){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 3, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, int_latency, 2);
+	ooo->init_exec_unit(ADDER, 3, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, mem_latency, 1);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	float values[12] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7, 41.5, -10.3};
+	for (unsigned i=0; i<12; i++) ooo->write_memory(0xA000+4*i, float2unsigned(values[i]));
+	return ooo;
+}
+
+int main(int argc, char **argv){
+	unsigned int_latencies[2] = {1, 3};
+	unsigned mem_latencies[3] = {1, 3, 5};
+
+	sim_ooo *prototype = build(3, 5);
+	sim_batch batch(*prototype);
+	delete prototype;
+	for (unsigned i=0; i<2; i++)
+		for (unsigned m=0; m<3; m++){
+			unsigned latency[NUM_UNIT_TYPES] = {int_latencies[i], 3, 10, 40, mem_latencies[m]};
+			batch.add_instance(latency);
+		}
+	batch.run();
+
+	unsigned n = 0;
+	for (unsigned i=0; i<2; i++)
+		for (unsigned m=0; m<3; m++, n++){
+			sim_ooo *ooo = build(int_latencies[i], mem_latencies[m]);
+			ooo->run();
+			const sim_result_t &r = batch.get_result(n);
+			cout << "INT " << dec << int_latencies[i] << " MEM " << mem_latencies[m]
+			     << ": instructions = " << r.instructions_executed << ", clock cycles = " << r.clock_cycles
+			     << ", standalone = " << ooo->get_instructions_executed() << "/" << ooo->get_clock_cycles()
+			     << (r.instructions_executed == ooo->get_instructions_executed() && r.clock_cycles == ooo->get_clock_cycles() ? " (same)" : " (DIFFERENT)") << endl;
+			delete ooo;
+		}
+	cout << endl << "Instances = 6, simulations = " << batch.get_simulations() << endl;
+
+	// sort.asm does not divide: instances differing only in the divider latency share one simulation
+	prototype = build(3, 5);
+	sim_batch shared(*prototype);
+	delete prototype;
+	unsigned div_latencies[3] = {10, 20, 40};
+	for (unsigned d=0; d<3; d++){
+		unsigned latency[NUM_UNIT_TYPES] = {3, 3, 10, div_latencies[d], 5};
+		shared.add_instance(latency);
+	}
+	shared.run();
+	for (unsigned d=0; d<3; d++)
+		cout << "DIV " << dec << div_latencies[d] << ": clock cycles = " << shared.get_result(d).clock_cycles << endl;
+	cout << "Instances = 3, simulations = " << shared.get_simulations() << endl << endl;
+
+	// a batch needs latencies of at least one cycle
+	try{
+		unsigned latency[NUM_UNIT_TYPES] = {0, 3, 10, 40, 5};
+		batch.add_instance(latency);
+		cout << "add_instance: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "add_instance: " << e.what() << endl;
+	}
+}
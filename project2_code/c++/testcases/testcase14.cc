@@ -0,0 +1,96 @@
+#include "sim_ooo.h"
+#include "sim_func.h"
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for functional-first simulation (initial state of testcase2: the branch is taken) */
+/* 1) dynamic instruction stream of the functional model                                      */
+/* 2) the timing model fed by the functional model gives the same log as testcase2.out        */
+/* 3) the functional model starts from the state at the first run(): later register writes    */
+/*    are not seen by the instructions it executes                                            */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* convert an unsigned into a float */
+inline float unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* testcase2 processor and initial state */
+sim_ooo *build(bool functional_first){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 1, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 2, 1);
+	ooo->init_exec_unit(ADDER, 2, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->load_program("asm/code_ooo.asm", 0x00000000);
+	ooo->set_functional_first(functional_first);
+	ooo->set_int_register(1, 10);
+	ooo->set_int_register(2, 20);
+	ooo->set_int_register(3, 0);
+	for (unsigned i=0; i<11; i++) ooo->set_fp_register(i, (float)i*10.0);
+	ooo->write_memory(0x14,float2unsigned(10.0));
+	ooo->write_memory(0x28,float2unsigned(30.0));
+	return ooo;
+}
+
+int main(int argc, char **argv){
+	unsigned i;
+
+	// 1) functional model alone
+	instruction_t program[PROGRAM_SIZE];
+	parse_program("asm/code_ooo.asm", program);
+	unsigned registers[NUM_GP_REGISTERS*2];
+	for (i=0; i<NUM_GP_REGISTERS*2; i++) registers[i] = UNDEFINED;
+	registers[1] = 10;
+	registers[2] = 20;
+	registers[3] = 0;
+	for (i=0; i<11; i++) registers[NUM_GP_REGISTERS+i] = float2unsigned((float)i*10.0);
+	sim_memory memory(64);
+	memory.write_word(0x14, float2unsigned(10.0));
+	memory.write_word(0x28, float2unsigned(30.0));
+	sim_func func(program, 0x00000000, registers, memory);
+	dyn_instr_t d;
+	cout << "DYNAMIC INSTRUCTIONS" << endl;
+	cout << setfill(' ') << setw(10) << "PC" << setw(12) << "Address" << setw(12) << "Result" << setw(7) << "Taken" << endl;
+	while (func.step(&d)){
+		cout << "0x" << hex << setfill('0') << setw(8) << d.pc << setfill(' ');
+		if (d.address != UNDEFINED) cout << "  0x" << setfill('0') << setw(8) << d.address << setfill(' ');
+		else cout << setw(12) << "-";
+		cout << "  0x" << setfill('0') << setw(8) << d.result << setfill(' ');
+		cout << setw(7) << (is_branch(d.opcode) ? (d.taken ? "yes" : "no") : "-") << endl;
+	}
+	cout << endl;
+
+	// 2) functional-first timing model
+	sim_ooo *ooo = build(true);
+	ooo->run();
+	ooo->print_log();
+	cout << endl << "Instruction executed = " << dec << ooo->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl;
+	cout << "F2 = " << ooo->get_fp_register(2) << ", F4 = " << ooo->get_fp_register(4) << endl << endl;
+	delete ooo;
+
+	// 3) F5 overwritten after the first clock cycle
+	for (unsigned ff=0; ff<2; ff++){
+		ooo = build(ff == 1);
+		ooo->run(1);
+		ooo->set_fp_register(5, 1000.0);
+		ooo->run();
+		cout << "functional-first " << (ff ? "on " : "off") << ": F2 = " << ooo->get_fp_register(2) << endl;
+		delete ooo;
+	}
+}
@@ -0,0 +1,113 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+#include "sim_multicore.h"
+
+using namespace std;
+
+/* Test case for the multicore: sort.asm (as in testcase9) and code_ooo2.asm (as in testcase4) on two cores */
+/* sharing the data memory (the sorted array must match testcase9.out, each core must match a single-core run) */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* convert an unsigned into a float */
+inline float unsigned2float(unsigned value){
+        float result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* input of sort.asm */
+static const float sort_data[12] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7, 41.5, -10.3};
+
+/* sets up the execution units and program of the core sorting the array (as in testcase9) */
+void setup_sort(sim_ooo &core){
+        core.init_exec_unit(INTEGER, 3, 2);
+        core.init_exec_unit(ADDER, 3, 2);
+        core.init_exec_unit(MULTIPLIER, 10, 1);
+        core.init_exec_unit(DIVIDER, 40, 1);
+        core.init_exec_unit(MEMORY, 5, 1);
+	core.load_program("asm/sort.asm", 0x00000000);
+	core.set_int_register(7, 0x80000000);
+}
+
+/* sets up the execution units and program of the core reading the same array (as in testcase4) */
+void setup_loop(sim_ooo &core){
+	unsigned i;
+        core.init_exec_unit(INTEGER, 2, 1);
+        core.init_exec_unit(ADDER, 2, 2);
+        core.init_exec_unit(MULTIPLIER, 10, 1);
+        core.init_exec_unit(DIVIDER, 40, 1);
+        core.init_exec_unit(MEMORY, 1, 1);
+	core.load_program("asm/code_ooo2.asm", 0x00000000);
+	for (i=0; i<5; i++) core.set_fp_register(i, (float)i);
+}
+
+int main(int argc, char **argv){
+	unsigned i;
+
+	// instantiates a multicore with a 1MB shared data memory, synchronized every 50 clock cycles
+	sim_multicore multicore(1024*1024, 50);
+	multicore.add_core(6, 3, 2, 2, 2, 2);	//rob size, int, add, mult, load reservation stations, issue width
+	multicore.add_core(6, 2, 2, 2, 1);
+	setup_sort(multicore.get_core(0));
+	setup_loop(multicore.get_core(1));
+
+	//initialize shared data memory: core 1 only reads the array core 0 sorts into 0xB000
+	for (i=0; i<12; i++) multicore.write_memory(0xA000 + 4*i, float2unsigned(sort_data[i]));
+
+	cout << "\nBEFORE PROGRAM EXECUTION..." << endl;
+	cout << "======================================================================" << endl << endl;
+	multicore.print_memory(0xA000, 0xA030);
+	multicore.print_memory(0xB000, 0xB030);
+
+	// 120 clock cycles: two full quanta and a partial one
+	multicore.run(120);
+	cout << "\nAfter 120 clock cycles: multicore = " << dec << multicore.get_clock_cycles() << ", core 0 = " << multicore.get_core(0).get_clock_cycles()
+	     << ", core 1 = " << multicore.get_core(1).get_clock_cycles() << endl;
+
+	// runs both programs to completion
+	cout << "\nEXECUTING PROGRAMS TO COMPLETION..." << endl << endl;
+	multicore.run();
+
+	cout << "PROGRAMS TERMINATED\n";
+	cout << "===================" << endl << endl;
+
+	//prints the registers of each core and the shared data memory
+	for (i=0; i<multicore.get_num_cores(); i++){
+		cout << "CORE " << dec << i << endl;
+		multicore.get_core(i).print_registers();
+		cout << endl;
+	}
+	multicore.print_memory(0xA000, 0xA030);
+	multicore.print_memory(0xB000, 0xB030);
+	cout << endl;
+
+	//each core must behave as the same program on a single-core simulator
+	sim_ooo sort(1024*1024, 6, 3, 2, 2, 2, 2);
+	sim_ooo loop(1024*1024, 6, 2, 2, 2, 1);
+	setup_sort(sort);
+	setup_loop(loop);
+	for (i=0; i<12; i++){
+		sort.write_memory(0xA000 + 4*i, float2unsigned(sort_data[i]));
+		loop.write_memory(0xA000 + 4*i, float2unsigned(sort_data[i]));
+	}
+	sort.run();
+	loop.run();
+	sim_ooo *single[2] = {&sort, &loop};
+
+	for (i=0; i<multicore.get_num_cores(); i++){
+		sim_ooo &core = multicore.get_core(i);
+		cout << "Core " << dec << i << ": instructions executed = " << core.get_instructions_executed()
+		     << ", clock cycles = " << core.get_clock_cycles()
+		     << " (single core: " << single[i]->get_instructions_executed() << ", " << single[i]->get_clock_cycles() << ")" << endl;
+	}
+	cout << "Multicore clock cycles = " << dec << multicore.get_clock_cycles() << endl;
+}
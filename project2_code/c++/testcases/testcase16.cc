@@ -0,0 +1,51 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the data TLB: asm/tlb.asm touches the 4KB pages 0, 0, 1, 2 (loads) and 1 (store) */
+/* - no TLB                                                                                      */
+/* - 2-entry fully associative TLB, 4KB pages: misses on pages 0, 1, 2 (2-level walk, 20 cycles) */
+/* - same TLB, 4MB huge pages: everything is on page 0, one miss (1-level walk, 10 cycles)       */
+/* DO NOT MODIFY */
+
+int main(int argc, char **argv){
+	unsigned page_sizes[3] = {0, 4096, 4*1024*1024};
+
+	for (unsigned t=0; t<3; t++){
+		sim_ooo *ooo = new sim_ooo(1024*1024, 8, 1, 1, 1, 4);
+		ooo->init_exec_unit(INTEGER, 1, 1);
+		ooo->init_exec_unit(ADDER, 1, 1);
+		ooo->init_exec_unit(MULTIPLIER, 1, 1);
+		ooo->init_exec_unit(DIVIDER, 1, 1);
+		ooo->init_exec_unit(MEMORY, 1, 1);
+		if (page_sizes[t] != 0) ooo->init_tlb(2, 2, page_sizes[t], 10);
+		ooo->load_program("asm/tlb.asm", 0x00000000);
+		ooo->set_int_register(0, 0);
+		ooo->run();
+
+		if (page_sizes[t] == 0) cout << "NO TLB" << endl;
+		else cout << "TLB, PAGE SIZE = " << dec << page_sizes[t] << endl;
+		ooo->print_log();
+		cout << "TLB accesses = " << dec << ooo->get_tlb_accesses() << ", misses = " << ooo->get_tlb_misses() << endl;
+		cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+		delete ooo;
+	}
+
+	// invalid geometries
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.init_tlb(6, 4, 4096, 10);
+		cout << "init_tlb: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_tlb: " << e.what() << endl;
+	}
+	try{
+		ooo.init_tlb(4, 2, 3000, 10);
+		cout << "init_tlb: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_tlb: " << e.what() << endl;
+	}
+}
@@ -0,0 +1,55 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the sparse data memory                                                           */
+/* - sim_memory: untouched pages read as 0xFF, a word across a page boundary allocates two pages, */
+/*   copies are deep and clear() releases every page                                              */
+/* - sim_ooo over the whole 32-bit address space: asm/sparse.asm loads from 0x80000000 and stores */
+/*   the value + 1 at 0xFFFFFFF0, touching two pages only                                         */
+/* DO NOT MODIFY */
+
+int main(int argc, char **argv){
+
+	sim_memory memory;
+	cout << "size = 0x" << hex << memory.get_size() << ", pages = " << dec << memory.get_touched_pages() << endl;
+	cout << "word[0x12345678] = 0x" << hex << memory.read_word(0x12345678) << endl;
+	memory.write_word(0x00001FFE, 0xAABBCCDD);
+	memory.write_word(0xFFFFFFF0, 0x11223344);
+	cout << "pages = " << dec << memory.get_touched_pages() << endl;
+	cout << "word[0x00001FFE] = 0x" << hex << memory.read_word(0x00001FFE) << ", byte[0x00002000] = 0x" << int(memory.read_byte(0x00002000)) << endl;
+
+	sim_memory copy(memory);
+	memory.clear();
+	cout << "after clear: pages = " << dec << memory.get_touched_pages() << ", word[0xFFFFFFF0] = 0x" << hex << memory.read_word(0xFFFFFFF0) << endl;
+	cout << "copy: pages = " << dec << copy.get_touched_pages() << ", word[0xFFFFFFF0] = 0x" << hex << copy.read_word(0xFFFFFFF0) << endl;
+
+	sim_memory small(0x100);
+	cout << "small.contains(0xFC, 4) = " << small.contains(0xFC, 4) << ", small.contains(0xFD, 4) = " << small.contains(0xFD, 4) << endl << endl;
+
+	sim_ooo *ooo = new sim_ooo(0, 4, 1, 1, 1, 1);
+	ooo->init_exec_unit(INTEGER, 1, 1);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->load_program("asm/sparse.asm", 0x00000000);
+	ooo->set_int_register(2, 0x80000000);
+	ooo->set_int_register(3, 0xFFFFFFF0);
+	ooo->write_memory(0x80000000, 41);
+	ooo->run();
+	ooo->print_memory(0xFFFFFFF0, 0xFFFFFFF8);
+	ooo->print_registers();
+	ooo->print_log();
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl;
+	try{
+		ooo->write_memory(0xFFFFFFFE, 0);
+		cout << "write_memory: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "write_memory: " << e.what() << endl;
+	}
+	delete ooo;
+}
@@ -0,0 +1,84 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+#include <stdio.h>
+
+using namespace std;
+
+/* Test case for the memory images                                                                */
+/* - an image of 2.5 pages (word at address A = A) is dumped and mapped back at the same address, */
+/*   over a page that was already written; writes to the mapped pages must not reach the file     */
+/* - sort.asm (as in testcase9) reads its input array from an image instead of 12 write_memory()   */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* input of sort.asm */
+static const float sort_data[12] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7, 41.5, -10.3};
+
+int main(int argc, char **argv){
+
+	const char *image = "testcase18.bin";
+
+	sim_memory source;
+	for (unsigned a=0x1000; a<0x3800; a+=4) source.write_word(a, a);
+	source.dump_image(image, 0x1000, 0x3800);
+
+	sim_memory memory;
+	memory.write_word(0x2000, 0xDEAD);
+	memory.map_image(image, 0x1000);
+	cout << "pages = " << dec << memory.get_touched_pages() << endl;
+	cout << hex << "word[0x1000] = 0x" << memory.read_word(0x1000) << ", word[0x2000] = 0x" << memory.read_word(0x2000)
+	     << ", word[0x37fc] = 0x" << memory.read_word(0x37FC) << ", word[0x3800] = 0x" << memory.read_word(0x3800) << endl;
+	memory.write_word(0x1000, 7);
+	memory.map_image(image, 0x10000);
+	cout << "after write: word[0x1000] = 0x" << memory.read_word(0x1000) << ", word[0x10000] = 0x" << memory.read_word(0x10000) << endl;
+	memory.clear();
+	cout << "after clear: pages = " << dec << memory.get_touched_pages() << ", word[0x1000] = 0x" << hex << memory.read_word(0x1000) << endl << endl;
+
+	try{
+		sim_memory small(0x2000);
+		small.map_image(image, 0x0);
+		cout << "map_image: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "map_image: " << e.what() << endl;
+	}
+	try{
+		memory.map_image("testcase18.missing", 0x0);
+		cout << "map_image: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "map_image: " << e.what() << endl;
+	}
+
+	sim_memory data;
+	for (unsigned i=0; i<12; i++) data.write_word(0xA000 + 4*i, float2unsigned(sort_data[i]));
+	data.dump_image(image, 0xA000, 0xA030);
+
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 3, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 3, 2);
+	ooo->init_exec_unit(ADDER, 3, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, 5, 1);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	ooo->load_memory_image(image, 0xA000);
+	ooo->run();
+	ooo->print_memory(0xB000, 0xB030);
+	cout << "Instruction executed = " << dec << ooo->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl;
+	ooo->dump_memory_image(image, 0xB000, 0xB030);
+	FILE *file = fopen(image, "rb");
+	fseek(file, 0, SEEK_END);
+	cout << "dumped " << dec << ftell(file) << " bytes" << endl;
+	fclose(file);
+	delete ooo;
+
+	remove(image);
+}
@@ -0,0 +1,60 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the bulk memory API and the little-endian word helpers                          */
+/* - store_le32/load_le32 byte order; blocks and words across a page boundary; unwritten bytes   */
+/* - sort.asm (as in testcase9) with its input written by one write_memory_block() call and its  */
+/*   output read back by one read_memory_block() call                                            */
+/* DO NOT MODIFY */
+
+/* input of sort.asm */
+static const float sort_data[12] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7, 41.5, -10.3};
+
+int main(int argc, char **argv){
+
+	unsigned char bytes[16];
+	store_le32(bytes, 0x11223344);
+	cout << hex << "store_le32: " << int(bytes[0]) << " " << int(bytes[1]) << " " << int(bytes[2]) << " " << int(bytes[3])
+	     << ", load_le32 = 0x" << load_le32(bytes) << endl;
+
+	sim_memory memory;
+	for (unsigned i=0; i<16; i++) bytes[i] = i;
+	memory.write_block(0x0FF8, bytes, 16);
+	cout << "pages = " << dec << memory.get_touched_pages() << endl;
+	cout << hex << "word[0x0ffe] = 0x" << memory.read_word(0x0FFE) << ", word[0x1004] = 0x" << memory.read_word(0x1004) << endl;
+	memory.write_word(0x1FFE, 0xAABBCCDD);
+	cout << "word[0x1ffe] = 0x" << memory.read_word(0x1FFE) << ", byte[0x1fff] = 0x" << int(memory.read_byte(0x1FFF)) << endl;
+	memory.read_block(0x1004, bytes, 8);
+	cout << "block[0x1004:0x100c] =";
+	for (unsigned i=0; i<8; i++) cout << " " << int(bytes[i]);
+	cout << endl << endl;
+
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 3, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 3, 2);
+	ooo->init_exec_unit(ADDER, 3, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, 5, 1);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	ooo->write_memory_block(0xA000, sort_data, sizeof sort_data);
+	ooo->run();
+	float sorted[12];
+	ooo->read_memory_block(0xB000, sorted, sizeof sorted);
+	cout << "sorted =";
+	for (unsigned i=0; i<10; i++) cout << " " << sorted[i]; // sort.asm only stores 10 elements (see testcase9.out)
+	cout << endl;
+	cout << "Instruction executed = " << dec << ooo->get_instructions_executed() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl;
+	try{
+		ooo->read_memory_block(1024*1024 - 8, sorted, sizeof sorted);
+		cout << "read_memory_block: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "read_memory_block: " << e.what() << endl;
+	}
+	delete ooo;
+}
@@ -0,0 +1,54 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the data cache hierarchy: asm/cache.asm loads lines 0x1000 and 0x1400, loads line  */
+/* 0x1000 again and stores to line 0x1400 (two memory units, 20 cycles main memory latency)         */
+/* - no caches: every access takes the MEMORY unit latency                                          */
+/* - L1D (256B, 2-way, 16B lines, 1 cycle) + L2 (1KB, 4-way, 5 cycles), blocking                    */
+/* - the same hierarchy, non-blocking with 2 MSHRs per level                                        */
+/* DO NOT MODIFY */
+
+int main(int argc, char **argv){
+	const char *names[3] = {"NO CACHES", "BLOCKING L1D + L2", "NON-BLOCKING L1D + L2 (2 MSHRs)"};
+
+	for (unsigned t=0; t<3; t++){
+		sim_ooo *ooo = new sim_ooo(1024*1024, 8, 1, 1, 1, 4, 1);
+		ooo->init_exec_unit(INTEGER, 1, 1);
+		ooo->init_exec_unit(ADDER, 1, 1);
+		ooo->init_exec_unit(MULTIPLIER, 1, 1);
+		ooo->init_exec_unit(DIVIDER, 1, 1);
+		ooo->init_exec_unit(MEMORY, 20, 2);
+		if (t > 0){
+			ooo->add_cache_level(256, 2, 16, 1, LRU, t == 2 ? 2 : 0);
+			ooo->add_cache_level(1024, 4, 16, 5, LRU, t == 2 ? 2 : 0);
+		}
+		ooo->load_program("asm/cache.asm", 0x00000000);
+		ooo->set_int_register(2, 0x1000);
+		ooo->run();
+
+		cout << names[t] << endl;
+		ooo->print_log();
+		if (t > 0) ooo->print_cache_stats();
+		cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+		delete ooo;
+	}
+
+	// invalid geometries
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.add_cache_level(1000, 2, 16, 1);
+		cout << "add_cache_level: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "add_cache_level: " << e.what() << endl;
+	}
+	try{
+		ooo.add_cache_level(256, 2, 16, 0);
+		cout << "add_cache_level: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "add_cache_level: " << e.what() << endl;
+	}
+}
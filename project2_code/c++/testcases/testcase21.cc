@@ -0,0 +1,80 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the reuse-distance analysis                                                        */
+/* - LRU stack distances of the line sequence A B C A B B D A                                       */
+/* - miss counts of sim_reuse against sim_cache for several LRU geometries on a pseudo-random stream */
+/* - miss ratio curves of sort.asm (as in testcase9)                                                */
+/* DO NOT MODIFY */
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+        unsigned result;
+        memcpy(&result, &value, sizeof value);
+        return result;
+}
+
+/* input of sort.asm */
+static const float sort_data[12] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7, 41.5, -10.3};
+
+int main(int argc, char **argv){
+
+	reuse_stack stack;
+	const char *sequence = "ABCABBDA";
+	cout << "distances:";
+	for (unsigned i=0; sequence[i]!=0; i++){
+		unsigned distance = stack.access(sequence[i]);
+		if (distance == UNDEFINED) cout << " " << sequence[i] << ":-";
+		else cout << " " << sequence[i] << ":" << dec << distance;
+	}
+	cout << endl << endl;
+
+	// one pass over the stream for all geometries, one cache simulation per geometry
+	const unsigned sizes[4] = {1024, 1024, 2048, 4096};
+	const unsigned ways[4] = {1, 2, 4, 8};
+	unsigned addresses[2000];
+	unsigned seed = 12345;
+	for (unsigned i=0; i<2000; i++){
+		seed = seed * 1103515245 + 12345;
+		addresses[i] = (seed >> 8) % 8192;
+	}
+	sim_reuse reuse(64, 64, 8);
+	for (unsigned i=0; i<2000; i++) reuse.access(addresses[i]);
+	for (unsigned c=0; c<4; c++){
+		sim_cache cache(sizes[c], ways[c], 64, 1);
+		for (unsigned i=0; i<2000; i++){
+			bool hit;
+			cache.probe(addresses[i], false, i, &hit);
+			if (!hit) cache.fill(addresses[i], false, i);
+		}
+		unsigned sets = sizes[c] / (64 * ways[c]);
+		cout << dec << sizes[c] << "B " << ways[c] << "-way: sim_cache misses = " << cache.get_misses()
+		     << ", sim_reuse misses = " << (unsigned)(reuse.miss_ratio(sets, ways[c]) * reuse.get_accesses() + 0.5) << endl;
+	}
+	cout << endl;
+
+	sim_ooo *ooo = new sim_ooo(1024*1024, 6, 3, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 3, 2);
+	ooo->init_exec_unit(ADDER, 3, 2);
+	ooo->init_exec_unit(MULTIPLIER, 10, 1);
+	ooo->init_exec_unit(DIVIDER, 40, 1);
+	ooo->init_exec_unit(MEMORY, 5, 1);
+	ooo->enable_reuse_analysis(16, 4, 4);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	for (unsigned i=0; i<12; i++) ooo->write_memory(0xA000 + 4*i, float2unsigned(sort_data[i]));
+	ooo->run();
+	ooo->get_reuse_analysis()->print_curves();
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl;
+	try{
+		ooo->enable_reuse_analysis(48);
+		cout << "enable_reuse_analysis: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "enable_reuse_analysis: " << e.what() << endl;
+	}
+	delete ooo;
+}
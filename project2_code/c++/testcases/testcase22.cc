@@ -0,0 +1,47 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the DRAM model: asm/dram.asm loads 0x0000 (bank 0, row 0), 0x0040 (bank 0, row 0), */
+/* 0x0800 (bank 1, row 0) and 0x1000 (bank 0, row 1) from a 1-channel, 2-bank DRAM with 2KB rows,    */
+/* tRCD = tCAS = tRP = 10 and 4-cycle bursts, without caches (4 memory units)                       */
+/* - open page policy: the second load is a row hit, scheduled before the row conflict of the fourth */
+/* - closed page policy                                                                              */
+/* - an L1D (64B lines) in front of the open page DRAM: the four lines miss, one cycle later each    */
+/* DO NOT MODIFY */
+
+int main(int argc, char **argv){
+	const char *names[3] = {"OPEN PAGE", "CLOSED PAGE", "L1D + OPEN PAGE"};
+
+	for (unsigned t=0; t<3; t++){
+		sim_ooo *ooo = new sim_ooo(1024*1024, 8, 1, 1, 1, 4, 1);
+		ooo->init_exec_unit(INTEGER, 1, 1);
+		ooo->init_exec_unit(ADDER, 1, 1);
+		ooo->init_exec_unit(MULTIPLIER, 1, 1);
+		ooo->init_exec_unit(DIVIDER, 1, 1);
+		ooo->init_exec_unit(MEMORY, 1, 4);
+		if (t == 2) ooo->add_cache_level(1024, 2, 64, 1, LRU, 4);
+		ooo->init_dram(1, 2, 2048, t == 1 ? CLOSED_PAGE : OPEN_PAGE, 10, 10, 10, 4, 64, 8);
+		ooo->load_program("asm/dram.asm", 0x00000000);
+		ooo->set_int_register(2, 0);
+		ooo->run();
+
+		cout << names[t] << endl;
+		ooo->print_log();
+		ooo->print_cache_stats();
+		cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+		delete ooo;
+	}
+
+	// invalid configuration
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.init_dram(3, 2);
+		cout << "init_dram: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_dram: " << e.what() << endl;
+	}
+}
@@ -0,0 +1,50 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the load/store queue (asm/lsq.asm, R1 = 0x100, R2 = 7, R6 = 0x200, R7 = 2)           */
+/* - LW R3 8(R1) waits for the address of the older SW R2 0(R5) (R5 comes from a 10-cycle DIV)       */
+/* - LW R4 0(R1) takes its value from SW R2 0(R1)                                                   */
+/* - LW R8 4(R1) partially overlaps SW R2 6(R1) and waits until the store writes the memory         */
+/* The program runs with a store forwarding latency of 1 and 3 clock cycles.                        */
+/* DO NOT MODIFY */
+
+int main(int argc, char **argv){
+	for (unsigned latency=1; latency<=3; latency+=2){
+		sim_ooo *ooo = new sim_ooo(1024*1024, 8, 2, 1, 1, 6, 1);
+		ooo->init_exec_unit(INTEGER, 1, 1);
+		ooo->init_exec_unit(ADDER, 1, 1);
+		ooo->init_exec_unit(MULTIPLIER, 1, 1);
+		ooo->init_exec_unit(DIVIDER, 10, 1);
+		ooo->init_exec_unit(MEMORY, 1, 1);
+		ooo->set_store_forwarding_latency(latency);
+		ooo->load_program("asm/lsq.asm", 0x00000000);
+		ooo->set_int_register(1, 0x100);
+		ooo->set_int_register(2, 7);
+		ooo->set_int_register(6, 0x200);
+		ooo->set_int_register(7, 2);
+		ooo->write_memory(0x104, 0x11111111);
+		ooo->write_memory(0x108, 0x22222222);
+		ooo->run();
+
+		cout << "STORE FORWARDING LATENCY = " << dec << latency << endl;
+		ooo->print_log();
+		cout << hex << "R3 = 0x" << ooo->get_int_register(3) << ", R4 = 0x" << ooo->get_int_register(4)
+		     << ", R8 = 0x" << ooo->get_int_register(8) << endl;
+		ooo->print_memory(0x100, 0x10c);
+		cout << "Forwarded loads = " << dec << ooo->get_forwarded_loads() << endl;
+		cout << "Disambiguation stalls = " << dec << ooo->get_disambiguation_stalls() << endl;
+		cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+		delete ooo;
+	}
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.set_store_forwarding_latency(0);
+		cout << "set_store_forwarding_latency: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "set_store_forwarding_latency: " << e.what() << endl;
+	}
+}
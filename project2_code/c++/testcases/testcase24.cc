@@ -0,0 +1,59 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for memory speculation with the store-set predictor (asm/memdep.asm)                  */
+/* Each of the 8 iterations loads a store address from the table at 0x1000 (10-cycle memory),        */
+/* stores the counter R2 (8..1) there and accumulates the word at 0xB000 into R9.                   */
+/* The stores of iterations 2, 5 and 7 write 0xB000: R9 = 0+0+6+6+6+3+3+1 = 25.                     */
+/* The program runs without memory speculation, with it, and with it under functional-first.       */
+/* DO NOT MODIFY */
+
+static const unsigned table[8] = {0xC000, 0xC000, 0xB000, 0xC000, 0xC000, 0xB000, 0xC000, 0xB000};
+
+void run(bool speculation, bool functional_first){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 16, 2, 2, 1, 4, 1);
+	ooo->init_exec_unit(INTEGER, 1, 1);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 10, 2);
+	if (speculation) ooo->enable_memory_speculation(64, 8);
+	ooo->set_functional_first(functional_first);
+	ooo->load_program("asm/memdep.asm", 0x00000000);
+	ooo->set_int_register(1, 0x1000);
+	ooo->set_int_register(2, 8);
+	ooo->set_int_register(3, 0xB000);
+	ooo->set_int_register(9, 0);
+	for (unsigned i=0; i<8; i++) ooo->write_memory(0x1000 + 4*i, table[i]);
+	ooo->write_memory(0xB000, 0);
+	ooo->write_memory(0xC000, 0);
+	ooo->run();
+
+	cout << "MEMORY SPECULATION = " << (speculation ? "on" : "off") << (functional_first ? " (functional-first)" : "") << endl;
+	cout << "R9 = " << dec << ooo->get_int_register(9) << endl;
+	ooo->print_memory(0xB000, 0xB004);
+	ooo->print_memory(0xC000, 0xC004);
+	cout << "Memory order violations = " << dec << ooo->get_memory_order_violations() << endl;
+	cout << "False dependences = " << dec << ooo->get_false_dependences() << endl;
+	cout << "Disambiguation stalls = " << dec << ooo->get_disambiguation_stalls() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(false, false);
+	run(true, false);
+	run(true, true);
+
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.enable_memory_speculation(0, 8);
+		cout << "enable_memory_speculation: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "enable_memory_speculation: " << e.what() << endl;
+	}
+}
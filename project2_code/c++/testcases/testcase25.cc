@@ -0,0 +1,55 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the post-commit store buffer (asm/stbuf.asm, R1 = 0x100, R2 = 0x0A0B0C0D, R6 = 0x200, R7 = 2) */
+/* - four stores to the lines 0x100 and 0x110 (16B lines); the store to 0x108 is combined with the one to    */
+/*   0x104, the store to 0x100 is already being written                                                        */
+/* - LW R3 4(R5) (R5 = 0x100 from a 10-cycle DIV) finds its bytes in the buffer and is forwarded                */
+/* - LW R4 20(R5) reads 0x114-0x117, of which only 0x114-0x115 are buffered: it waits for the drain             */
+/* The program runs without a store buffer, with 4 entries and with 1 entry.                                   */
+/* DO NOT MODIFY */
+
+void run(unsigned entries){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 8, 2, 1, 1, 4, 1);
+	ooo->init_exec_unit(INTEGER, 1, 1);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 10, 1);
+	if (entries > 0) ooo->set_store_buffer(entries, 16);
+	ooo->load_program("asm/stbuf.asm", 0x00000000);
+	ooo->set_int_register(1, 0x100);
+	ooo->set_int_register(2, 0x0A0B0C0D);
+	ooo->set_int_register(6, 0x200);
+	ooo->set_int_register(7, 2);
+	ooo->run();
+
+	cout << "STORE BUFFER ENTRIES = " << dec << entries << endl;
+	ooo->print_log();
+	cout << hex << "R3 = 0x" << ooo->get_int_register(3) << ", R4 = 0x" << ooo->get_int_register(4) << endl;
+	ooo->print_memory(0x100, 0x118);
+	cout << "Store commit stalls = " << dec << ooo->get_store_commit_stalls() << endl;
+	cout << "Combined stores = " << dec << ooo->get_combined_stores() << endl;
+	cout << "Forwarded loads = " << dec << ooo->get_forwarded_loads() << endl;
+	cout << "Disambiguation stalls = " << dec << ooo->get_disambiguation_stalls() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(0);
+	run(4);
+	run(1);
+
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.set_store_buffer(4, 12);
+		cout << "set_store_buffer: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "set_store_buffer: " << e.what() << endl;
+	}
+}
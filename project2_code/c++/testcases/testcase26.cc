@@ -0,0 +1,52 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the load/store ports and banks of the data memory (asm/ports.asm, R1 = 0x100)          */
+/* Four independent loads of consecutive words and two stores, issued 4 per cycle to 4 MEMORY units.     */
+/* The program runs without the port model and with 2 load ports and 1 store port in front of:            */
+/* - 2 banks interleaved every 8B (0x100/0x104 and 0x108/0x10c fall in the same bank)                       */
+/* - 4 banks interleaved every 4B (no conflicts)                                                           */
+/* and with a single load port in front of 4 banks.                                                        */
+/* DO NOT MODIFY */
+
+void run(unsigned load_ports, unsigned banks, unsigned interleave){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 8, 1, 1, 1, 6, 4);
+	ooo->init_exec_unit(INTEGER, 1, 1);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 2, 4);
+	ooo->set_memory_ports(load_ports, 1, banks, interleave);
+	ooo->load_program("asm/ports.asm", 0x00000000);
+	ooo->set_int_register(1, 0x100);
+	for (unsigned i=0; i<4; i++) ooo->write_memory(0x100 + 4*i, i + 1);
+	ooo->run();
+
+	if (load_ports == 0) cout << "NO PORT MODEL" << endl;
+	else cout << "LOAD PORTS = " << dec << load_ports << ", BANKS = " << banks << " x " << interleave << "B" << endl;
+	ooo->print_log();
+	ooo->print_memory(0x110, 0x118);
+	ooo->print_cache_stats();
+	cout << "Port stalls = " << dec << ooo->get_port_stalls() << ", bank conflicts = " << ooo->get_bank_conflicts() << endl;
+	cout << "Clock cycles = " << dec << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(0, 1, 8);
+	run(2, 2, 8);
+	run(2, 4, 4);
+	run(1, 4, 4);
+
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.set_memory_ports(2, 0);
+		cout << "set_memory_ports: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "set_memory_ports: " << e.what() << endl;
+	}
+}
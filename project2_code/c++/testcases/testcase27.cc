@@ -0,0 +1,47 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the branch predictors and the BTB (asm/branch.asm, R1 = 16, R3 = 1, R5 = 0)                */
+/* The loop runs 16 times: BNEZ R1 LOOP is taken 15 times, BEQZ R4 SKIP alternates (taken when R1 is even).  */
+/* R5 counts the odd values of R1 and must be 8 in every run.                                                */
+/* DO NOT MODIFY */
+
+void run(bool predictor, branch_predictor_t type){
+	sim_ooo *ooo = new sim_ooo(1024, 16, 4, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 1, 2);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	if (predictor) ooo->init_branch_predictor(type, 256, 8, 16, 2);
+	ooo->load_program("asm/branch.asm", 0x00000000);
+	ooo->set_int_register(1, 16);
+	ooo->set_int_register(3, 1);
+	ooo->set_int_register(5, 0);
+	ooo->run();
+
+	ooo->print_branch_stats();
+	cout << "R5 = " << dec << ooo->get_int_register(5) << ", instructions = " << ooo->get_instructions_executed()
+	     << ", clock cycles = " << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(false, STATIC_NOT_TAKEN);
+	run(true, STATIC_NOT_TAKEN);
+	run(true, BIMODAL);
+	run(true, GSHARE);
+	run(true, TAGE_LITE);
+
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.init_branch_predictor(BIMODAL, 256, 8, 6, 4);
+		cout << "init_branch_predictor: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_branch_predictor: " << e.what() << endl;
+	}
+}
@@ -0,0 +1,40 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for early branch resolution (asm/branch.asm, R1 = 16, R3 = 1, R5 = 0, bimodal predictor)       */
+/* Every misprediction is repaired when the branch writes its result: the number of early redirects equals   */
+/* the number of mispredictions, and the issue waits "penalty" clock cycles after each of them.              */
+/* R5 counts the odd values of R1 and must be 8 in every run.                                                */
+/* DO NOT MODIFY */
+
+void run(bool early, unsigned penalty){
+	sim_ooo *ooo = new sim_ooo(1024, 16, 4, 2, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 1, 2);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->init_branch_predictor(BIMODAL, 256, 8, 16, 2);
+	ooo->set_early_branch_resolution(early, penalty);
+	ooo->load_program("asm/branch.asm", 0x00000000);
+	ooo->set_int_register(1, 16);
+	ooo->set_int_register(3, 1);
+	ooo->set_int_register(5, 0);
+	ooo->run();
+
+	ooo->print_branch_stats();
+	cout << "R5 = " << dec << ooo->get_int_register(5) << ", instructions = " << ooo->get_instructions_executed()
+	     << ", clock cycles = " << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(false, 0);
+	run(true, 0);
+	run(true, 1);
+	run(true, 3);
+}
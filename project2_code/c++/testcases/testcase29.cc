@@ -0,0 +1,52 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the decoupled front end (asm/fetch.asm, R1 = 20: a loop of 7 instructions, bimodal predictor) */
+/* A 4-wide back end runs the loop without a front end, then behind front ends of different fetch widths,   */
+/* taken-branch bubbles and decode latencies. R2..R6 must be 20, 40, 60, 80, 100 in every run.                */
+/* DO NOT MODIFY */
+
+void run(unsigned fetch_width, unsigned bubbles, unsigned decode_latency){
+	sim_ooo *ooo = new sim_ooo(1024, 32, 4, 8, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 1, 4);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->init_branch_predictor(BIMODAL, 256, 8, 16, 2);
+	if (fetch_width != 0) ooo->init_front_end(fetch_width, 8, bubbles, decode_latency);
+	ooo->load_program("asm/fetch.asm", 0x00000000);
+	ooo->set_int_register(1, 20);
+	for (unsigned i=2; i<=6; i++) ooo->set_int_register(i, 0);
+	ooo->run();
+
+	if (fetch_width == 0) cout << "no front end";
+	else cout << "fetch width " << fetch_width << ", bubbles " << bubbles << ", decode latency " << decode_latency;
+	cout << ": front-end stalls = " << ooo->get_frontend_stalls() << ", fetch bubbles = " << ooo->get_fetch_bubbles()
+	     << ", mispredictions = " << ooo->get_branch_mispredictions() << endl;
+	cout << "R2..R6 = ";
+	for (unsigned i=2; i<=6; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", instructions = " << ooo->get_instructions_executed() << ", clock cycles = " << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(0, 0, 0);
+	run(4, 0, 1);
+	run(4, 1, 1);
+	run(1, 0, 1);
+	run(1, 1, 1);
+	run(8, 2, 3);
+
+	sim_ooo ooo(1024, 4, 1, 1, 1, 1);
+	try{
+		ooo.init_front_end(4, 0);
+		cout << "init_front_end: no error" << endl;
+	} catch (const sim_error &e){
+		cout << "init_front_end: " << e.what() << endl;
+	}
+}
@@ -0,0 +1,41 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for the loop buffer (asm/fetch.asm, R1 = 20: a loop of 7 instructions, bimodal predictor)       */
+/* The front end fetches 1 instruction per cycle and idles 2 cycles after every taken branch. A loop buffer  */
+/* of 7 or more entries captures the body and removes the bubbles; a 6-entry one is too small.               */
+/* R2..R6 must be 20, 40, 60, 80, 100 in every run.                                                          */
+/* DO NOT MODIFY */
+
+void run(unsigned loop_buffer){
+	sim_ooo *ooo = new sim_ooo(1024, 32, 4, 8, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 1, 4);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->init_branch_predictor(BIMODAL, 256, 8, 16, 2);
+	ooo->init_front_end(1, 8, 2, 3);
+	ooo->set_loop_buffer(loop_buffer);
+	ooo->load_program("asm/fetch.asm", 0x00000000);
+	ooo->set_int_register(1, 20);
+	for (unsigned i=2; i<=6; i++) ooo->set_int_register(i, 0);
+	ooo->run();
+
+	ooo->print_branch_stats();
+	cout << "R2..R6 = ";
+	for (unsigned i=2; i<=6; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", instructions = " << ooo->get_instructions_executed() << ", clock cycles = " << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(0);
+	run(6);
+	run(7);
+	run(16);
+}
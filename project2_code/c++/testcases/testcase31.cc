@@ -0,0 +1,46 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for macro-op fusion (asm/fetch.asm, R1 = 20: a loop of 7 instructions ending in SUBI R1 / BNEZ R1) */
+/* Every mode runs without and with fusion: the SUBI/BNEZ pair of each iteration takes a single ROB entry.      */
+/* R2..R6 must be 20, 40, 60, 80, 100 and the instruction count 140 in every run.                               */
+/* DO NOT MODIFY */
+
+typedef enum {NO_PREDICTOR, PREDICTOR, FRONT_END, EARLY_RESOLUTION, FUNCTIONAL_FIRST} run_mode_t;
+
+void run(run_mode_t mode, bool fusion){
+	static const char *names[] = {"no predictor", "bimodal", "bimodal + front end", "early resolution", "functional-first"};
+	sim_ooo *ooo = new sim_ooo(1024, 8, 4, 8, 2, 2, 2);
+	ooo->init_exec_unit(INTEGER, 1, 4);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	if (mode != NO_PREDICTOR) ooo->init_branch_predictor(BIMODAL, 256, 8, 16, 2);
+	if (mode == FRONT_END) ooo->init_front_end(4, 8, 1, 1);
+	if (mode == EARLY_RESOLUTION) ooo->set_early_branch_resolution(true, 1);
+	if (mode == FUNCTIONAL_FIRST) ooo->set_functional_first(true);
+	ooo->set_macro_op_fusion(fusion);
+	ooo->load_program("asm/fetch.asm", 0x00000000);
+	ooo->set_int_register(1, 20);
+	for (unsigned i=2; i<=6; i++) ooo->set_int_register(i, 0);
+	ooo->run();
+
+	cout << names[mode] << (fusion ? ", fusion: " : ": ") << "fused pairs = " << ooo->get_fused_pairs()
+	     << ", fusion rate = " << ooo->get_fusion_rate() << ", mispredictions = " << ooo->get_branch_mispredictions() << endl;
+	cout << "R2..R6 = ";
+	for (unsigned i=2; i<=6; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", instructions = " << ooo->get_instructions_executed() << ", clock cycles = " << ooo->get_clock_cycles() << endl << endl;
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	for (int mode=NO_PREDICTOR; mode<=FUNCTIONAL_FIRST; mode++){
+		run((run_mode_t)mode, false);
+		run((run_mode_t)mode, true);
+	}
+}
@@ -0,0 +1,66 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* Test case for the commit width (asm/fetch.asm, R1 = 20: a loop of 7 instructions, bimodal predictor)      */
+/* A 4-wide machine (6 INTEGER units) retires 1, 2 and 4 instructions per cycle; then asm/sort.asm (data of */
+/* testcase9) runs with 1 and 4. R2..R6 must be 20, 40, 60, 80, 100, and the array at 0xB000 sorted.        */
+/* DO NOT MODIFY */
+
+void run_loop(unsigned commit_width){
+	sim_ooo *ooo = new sim_ooo(1024, 32, 16, 2, 2, 2, 4, commit_width);
+	ooo->init_exec_unit(INTEGER, 1, 6);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->init_branch_predictor(BIMODAL, 256, 8, 16, 2);
+	ooo->load_program("asm/fetch.asm", 0x00000000);
+	ooo->set_int_register(1, 20);
+	for (unsigned i=2; i<=6; i++) ooo->set_int_register(i, 0);
+	ooo->run();
+
+	cout << "loop, commit width " << commit_width << ": R2..R6 = ";
+	for (unsigned i=2; i<=6; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", instructions = " << ooo->get_instructions_executed() << ", clock cycles = " << ooo->get_clock_cycles()
+	     << ", ROB stalls = " << ooo->get_rob_stalls() << endl;
+	delete ooo;
+}
+
+void run_sort(unsigned commit_width){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 16, 4, 3, 2, 4, 4, commit_width);
+	ooo->init_exec_unit(INTEGER, 1, 2);
+	ooo->init_exec_unit(ADDER, 2, 1);
+	ooo->init_exec_unit(MULTIPLIER, 6, 1);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 3, 1);
+	ooo->init_branch_predictor(GSHARE);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	float values[10] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7};
+	for (unsigned i=0; i<10; i++) ooo->write_memory(0xA000 + 4*i, float2unsigned(values[i]));
+	ooo->run();
+
+	cout << "sort, commit width " << dec << commit_width << ": instructions = " << ooo->get_instructions_executed()
+	     << ", clock cycles = " << ooo->get_clock_cycles() << endl;
+	ooo->print_memory(0xB000, 0xB028);
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run_loop(1);
+	run_loop(2);
+	run_loop(4);
+	run_sort(1);
+	run_sort(4);
+}
@@ -0,0 +1,65 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* Test case for group rename (asm/rename.asm: 8 instructions with dependences inside the issue group - RAW, WAW, */
+/* and integer/FP registers with the same number). At widths 1, 2, 4 and 8 the registers must be                 */
+/* R1..R5 = 6 3 9 3 12 and F1 = 3.5, F4 = 7; at width 8 the whole program issues in clock cycle 0.               */
+/* Then asm/sort.asm (data of testcase9) runs at widths 1, 2, 4 and 8, and the array at 0xB000 must be sorted.  */
+/* DO NOT MODIFY */
+
+void run_rename(unsigned width){
+	sim_ooo *ooo = new sim_ooo(1024, 16, 8, 2, 2, 2, width, width);
+	ooo->init_exec_unit(INTEGER, 1, 6);
+	ooo->init_exec_unit(ADDER, 1, 1);
+	ooo->init_exec_unit(MULTIPLIER, 1, 1);
+	ooo->init_exec_unit(DIVIDER, 1, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->load_program("asm/rename.asm", 0x00000000);
+	ooo->set_int_register(1, 0);
+	ooo->set_fp_register(2, 1.5);
+	ooo->set_fp_register(3, 2.0);
+	ooo->run();
+
+	cout << "rename, width " << width << ": R1..R5 = ";
+	for (unsigned i=1; i<=5; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", F1 = " << ooo->get_fp_register(1) << ", F4 = " << ooo->get_fp_register(4)
+	     << ", clock cycles = " << ooo->get_clock_cycles() << endl;
+	if (width == 8) ooo->print_log();
+	delete ooo;
+}
+
+void run_sort(unsigned width){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 32, 8, 4, 2, 4, width, width);
+	ooo->init_exec_unit(INTEGER, 1, 4);
+	ooo->init_exec_unit(ADDER, 2, 2);
+	ooo->init_exec_unit(MULTIPLIER, 6, 1);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 3, 2);
+	ooo->init_branch_predictor(BIMODAL);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	float values[10] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7};
+	for (unsigned i=0; i<10; i++) ooo->write_memory(0xA000 + 4*i, float2unsigned(values[i]));
+	ooo->run();
+
+	cout << "sort, width " << dec << width << ": instructions = " << ooo->get_instructions_executed()
+	     << ", clock cycles = " << ooo->get_clock_cycles() << endl;
+	ooo->print_memory(0xB000, 0xB028);
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	for (unsigned width=1; width<=8; width*=2) run_rename(width);
+	for (unsigned width=1; width<=8; width*=2) run_sort(width);
+}
@@ -0,0 +1,43 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* Test case for pipelined execution units (asm/pipeline.asm: 8 independent MULTS, F0 = 1.5)                */
+/* A 4-wide machine with one 4-cycle MULTIPLIER: unpipelined, and with initiation intervals 2 and 1.        */
+/* F1..F8 must be 2.25 in every run. A MULTIPLIER with 33 operations in flight exceeds MAX_UNIT_ENTRIES.    */
+/* DO NOT MODIFY */
+
+void run(unsigned initiation_interval){
+	sim_ooo *ooo = new sim_ooo(1024, 16, 2, 2, 8, 2, 4, 4);
+	ooo->init_exec_unit(INTEGER, 1, 1);
+	ooo->init_exec_unit(ADDER, 2, 1);
+	ooo->init_exec_unit(MULTIPLIER, 4, 1, initiation_interval);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->load_program("asm/pipeline.asm", 0x00000000);
+	ooo->set_fp_register(0, 1.5);
+	ooo->run();
+
+	cout << "initiation interval " << initiation_interval << ": F1..F8 = ";
+	for (unsigned i=1; i<=8; i++) cout << ooo->get_fp_register(i) << " ";
+	cout << ", clock cycles = " << ooo->get_clock_cycles() << endl;
+	ooo->print_log();
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run(0);
+	run(2);
+	run(1);
+
+	sim_ooo *ooo = new sim_ooo(1024, 16, 2, 2, 8, 2, 4, 4);
+	try{
+		ooo->init_exec_unit(MULTIPLIER, 32, 1, 1);
+	}catch (const sim_error &e){
+		cout << "32-cycle MULTIPLIER with initiation interval 1: " << e.what() << endl;
+	}
+	delete ooo;
+}
@@ -0,0 +1,71 @@
+#include "sim_ooo.h"
+#include <iostream>
+#include <stdlib.h>
+#include <sstream>
+
+using namespace std;
+
+/* convert a float into an unsigned */
+inline unsigned float2unsigned(float value){
+	unsigned result;
+	memcpy(&result, &value, sizeof value);
+	return result;
+}
+
+/* Test case for the common data buses (asm/cdb.asm: a MULTS and three ADDI, all due in clock cycle 3)      */
+/* A 4-wide machine runs it with unlimited buses, one bus (oldest first and unit order) and two buses.       */
+/* R2..R4 must be 11 12 13 and F2 = 6.25 in every run. Then asm/sort.asm (data of testcase9) runs at width 4 */
+/* with unlimited buses, two and one, and the array at 0xB000 must be sorted.                                */
+/* DO NOT MODIFY */
+
+void run_cdb(unsigned num_cdbs, cdb_arbitration_t arbitration){
+	sim_ooo *ooo = new sim_ooo(1024, 8, 4, 2, 2, 2, 4, 4);
+	ooo->init_exec_unit(INTEGER, 2, 3);
+	ooo->init_exec_unit(ADDER, 2, 1);
+	ooo->init_exec_unit(MULTIPLIER, 2, 1);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 1, 1);
+	ooo->set_cdbs(num_cdbs, arbitration);
+	ooo->load_program("asm/cdb.asm", 0x00000000);
+	ooo->set_int_register(1, 10);
+	ooo->set_fp_register(1, 2.5);
+	ooo->run();
+
+	cout << num_cdbs << " buses, " << (arbitration == OLDEST_FIRST ? "oldest first" : "unit order") << ": R2..R4 = ";
+	for (unsigned i=2; i<=4; i++) cout << ooo->get_int_register(i) << " ";
+	cout << ", F2 = " << ooo->get_fp_register(2) << ", clock cycles = " << ooo->get_clock_cycles()
+	     << ", conflicts = " << ooo->get_cdb_conflicts() << ", utilization = " << ooo->get_cdb_utilization() << endl;
+	ooo->print_log();
+	delete ooo;
+}
+
+void run_sort(unsigned num_cdbs){
+	sim_ooo *ooo = new sim_ooo(1024*1024, 32, 8, 4, 2, 4, 4, 4);
+	ooo->init_exec_unit(INTEGER, 1, 4);
+	ooo->init_exec_unit(ADDER, 2, 2);
+	ooo->init_exec_unit(MULTIPLIER, 6, 1);
+	ooo->init_exec_unit(DIVIDER, 10, 1);
+	ooo->init_exec_unit(MEMORY, 3, 2);
+	ooo->init_branch_predictor(BIMODAL);
+	ooo->set_cdbs(num_cdbs);
+	ooo->load_program("asm/sort.asm", 0x00000000);
+	ooo->set_int_register(7, 0x80000000);
+	float values[10] = {15.5, 3.1, 23.0, 1.3, 4.4, 12.6, 0.0, -12.1, 30.2, 44.7};
+	for (unsigned i=0; i<10; i++) ooo->write_memory(0xA000 + 4*i, float2unsigned(values[i]));
+	ooo->run();
+
+	cout << "sort, " << dec << num_cdbs << " buses: instructions = " << ooo->get_instructions_executed()
+	     << ", clock cycles = " << ooo->get_clock_cycles() << ", conflicts = " << ooo->get_cdb_conflicts() << endl;
+	ooo->print_memory(0xB000, 0xB028);
+	delete ooo;
+}
+
+int main(int argc, char **argv){
+	run_cdb(0, OLDEST_FIRST);
+	run_cdb(1, OLDEST_FIRST);
+	run_cdb(1, UNIT_ORDER);
+	run_cdb(2, OLDEST_FIRST);
+	run_sort(0);
+	run_sort(2);
+	run_sort(1);
+}